@@ -0,0 +1,154 @@
+// async_logger.h
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include "config.h"
+#include <atomic>
+#include <type_traits>
+
+// One deferred message: the format string, whose address identifies it (it
+// must be a literal), and its integer arguments, formatted only when drained
+struct LogEntry {
+  std::atomic<uint32_t> sequence;   // Slot state for the ring protocol in push()
+  uint32_t timeUs;
+  const char* format;
+  uint32_t args[Config::LOG_MAX_ARGS];
+};
+
+// Logging for the hot paths. Producers store the format and arguments into
+// the ring of the core they run on, which never blocks: a full ring drops the
+// message and counts it. The log task drains both rings in time order through
+// Serial at low priority.
+class AsyncLogger {
+private:
+  // Bounded ring with a sequence number per slot, so tasks preempting each
+  // other on the same core can claim slots without a lock
+  struct Ring {
+    LogEntry entries[Config::LOG_RING_SIZE];
+    std::atomic<uint32_t> writePos;
+    uint32_t readPos;               // Log task only
+  };
+  
+  Ring rings[2];
+  std::atomic<uint32_t> messagesLogged;
+  std::atomic<uint32_t> messagesDropped;
+  
+  AsyncLogger();
+  
+  bool push(const char* format, const uint32_t* args, uint8_t count);
+  LogEntry* peek(Ring& ring);
+  
+  template <typename T>
+  static uint32_t argument(T value) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "log arguments must be integers (format with %d, %u or %x)");
+    return (uint32_t)value;
+  }
+  
+public:
+  static AsyncLogger& getInstance() {
+    static AsyncLogger instance;
+    return instance;
+  }
+  
+  // Queues a printf-style message with up to LOG_MAX_ARGS integer arguments;
+  // false when the ring was full and the message dropped
+  template <typename... Args>
+  bool log(const char* format, Args... args) {
+    static_assert(sizeof...(Args) <= Config::LOG_MAX_ARGS, "too many log arguments");
+    uint32_t values[Config::LOG_MAX_ARGS] = { argument(args)... };
+    return push(format, values, sizeof...(Args));
+  }
+  
+  // Prints everything queued so far, oldest first; returns the message count
+  uint32_t drain();
+  
+  uint32_t getLoggedMessages() const { return messagesLogged.load(std::memory_order_relaxed); }
+  uint32_t getDroppedMessages() const { return messagesDropped.load(std::memory_order_relaxed); }
+  void printStatus() const;
+};
+
+#endif // ASYNC_LOGGER_H
+
+// async_logger.cpp
+#include "async_logger.h"
+
+static_assert((Config::LOG_RING_SIZE & (Config::LOG_RING_SIZE - 1)) == 0,
+              "LOG_RING_SIZE must be a power of two");
+static_assert(Config::LOG_MAX_ARGS == 4, "drain() passes exactly four arguments");
+
+AsyncLogger::AsyncLogger() : messagesLogged(0), messagesDropped(0) {
+  for (uint8_t core = 0; core < 2; core++) {
+    Ring& ring = rings[core];
+    for (uint32_t i = 0; i < Config::LOG_RING_SIZE; i++) {
+      ring.entries[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ring.writePos.store(0, std::memory_order_relaxed);
+    ring.readPos = 0;
+  }
+}
+
+// A slot is free for write position pos when its sequence equals pos, and
+// holds a message for read position pos when it equals pos + 1
+bool AsyncLogger::push(const char* format, const uint32_t* args, uint8_t count) {
+  Ring& ring = rings[xPortGetCoreID() & 1];
+  uint32_t pos = ring.writePos.load(std::memory_order_relaxed);
+  
+  while (true) {
+    LogEntry& entry = ring.entries[pos & (Config::LOG_RING_SIZE - 1)];
+    int32_t lag = (int32_t)(entry.sequence.load(std::memory_order_acquire) - pos);
+    
+    if (lag == 0) {
+      if (ring.writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        entry.timeUs = micros();
+        entry.format = format;
+        for (uint8_t i = 0; i < Config::LOG_MAX_ARGS; i++) entry.args[i] = i < count ? args[i] : 0;
+        entry.sequence.store(pos + 1, std::memory_order_release);
+        messagesLogged.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    } else if (lag < 0) {
+      // Slot not yet drained: the ring is full
+      messagesDropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = ring.writePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+LogEntry* AsyncLogger::peek(Ring& ring) {
+  LogEntry& entry = ring.entries[ring.readPos & (Config::LOG_RING_SIZE - 1)];
+  return entry.sequence.load(std::memory_order_acquire) == ring.readPos + 1 ? &entry : nullptr;
+}
+
+uint32_t AsyncLogger::drain() {
+  uint32_t printed = 0;
+  
+  while (true) {
+    LogEntry* first = peek(rings[0]);
+    LogEntry* second = peek(rings[1]);
+    if (!first && !second) break;
+    
+    // Merge the two cores' messages by time
+    uint8_t core = (!first || (second && (int32_t)(second->timeUs - first->timeUs) < 0)) ? 1 : 0;
+    Ring& ring = rings[core];
+    LogEntry& entry = core ? *second : *first;
+    
+    // Copy out and free the slot before the slow part
+    const char* format = entry.format;
+    uint32_t args[Config::LOG_MAX_ARGS];
+    memcpy(args, entry.args, sizeof(args));
+    entry.sequence.store(ring.readPos + Config::LOG_RING_SIZE, std::memory_order_release);
+    ring.readPos++;
+    
+    Serial.printf(format, args[0], args[1], args[2], args[3]);
+    printed++;
+  }
+  
+  return printed;
+}
+
+void AsyncLogger::printStatus() const {
+  Serial.printf("Log: Messages=%d, Dropped=%d\n", getLoggedMessages(), getDroppedMessages());
+}
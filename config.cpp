@@ -14,18 +14,86 @@ namespace Config {
   const uint16_t DISPLAY_WIDTH = 480;
   const uint16_t DISPLAY_HEIGHT = 320;
   const uint8_t DISPLAY_ROTATION = 1;
+  const int16_t VIEWPORT_X = -1;          // QVGA lands at (80, 40)
+  const int16_t VIEWPORT_Y = -1;
+  const uint16_t BORDER_COLOR = TFT_BLACK;
+  
+  // Scaling Configuration
+  const ScaleMode SCALE_MODE = SCALE_OFF;   // Costs a second strip buffer; see scale_qvga_* in the benchmark
+  const bool SCALE_KEEP_ASPECT = true;
   
   // High-Speed Configuration
   const uint32_t MAX_FRAME_SIZE = 35000;
   const uint32_t FRAME_TIMEOUT = 150;
+  const uint32_t FRAME_TIMEOUT_CHECK_INTERVAL = 10; // Also the UDP receive timeout
   const uint32_t MIN_HEAP_SIZE = 15000;
   const uint32_t TARGET_FPS = 60;
   const uint32_t MIN_RENDER_INTERVAL = 16;   // 16ms = 60 FPS
   const uint32_t FAST_RENDER_INTERVAL = 8;   // 8ms = 125 FPS
   
-  // Display Buffer Configuration
-  const uint32_t DISPLAY_BUFFER_SIZE = DISPLAY_WIDTH * DISPLAY_HEIGHT * 2; // 16-bit pixels
-  const uint16_t STRIP_HEIGHT = 20;
-  const uint16_t FAST_STRIP_HEIGHT = 10;
+  // Strip Buffer Configuration
+  const uint32_t STRIP_BUFFER_SIZE = DISPLAY_WIDTH * STRIP_ROWS * 2; // 16-bit pixels, 15 KB
+  const bool STRIP_DMA = true;
+  const uint32_t STRIP_DMA_HEAP_RESERVE = 60000;  // WiFi starts after the display
+  const bool DIRTY_BLOCKS = true;            // 4.8 KB of signatures
   const uint16_t MAX_PACKETS = 500;
+  const uint16_t PACKET_PAYLOAD_SIZE = WireProto::PAYLOAD_SIZE;
+  
+  // Frame Reassembly Configuration
+  const SlotEvictionPolicy SLOT_EVICTION_POLICY = EVICT_OLDEST;
+  const bool ACCEPT_V1_PACKETS = true;
+  
+  // Forward Error Correction Configuration
+  const bool FEC_ENABLED = true;  // Group size is set by the camera (FEC_GROUP_SIZE)
+  
+  // Retransmission (NACK) Configuration
+  const bool NACK_ENABLED = true;
+  const uint16_t NACK_MAX_MISSING = 8;    // Frames further behind are left to time out
+  const uint8_t NACK_MAX_ATTEMPTS = 2;    // Requests per frame
+  const uint32_t NACK_STALL_TIME = 20;    // Silence after which a short frame is considered sent
+  const uint32_t NACK_INITIAL_RTT = 15;   // Request-to-repair estimate until measured
+  
+  // Network Impairment (debug) Configuration
+  const bool IMPAIRMENT_ENABLED = false;  // Degrade received traffic on purpose
+  const uint32_t IMPAIRMENT_SEED = 1;
+  const ImpairmentProfile IMPAIRMENT_PROFILE = {
+    "wifi-burst", 0.005f, 0.01f, 0.3f, 0.5f, 0.01f, 3000, 0.002f, 0.0f, 2000
+  };
+  
+  // Packet Capture Configuration
+  const bool CAPTURE_ENABLED = false;     // Or "capture start" on the serial console
+  const char* CAPTURE_FILE = "capture.wcap";
+  
+  // Event Trace Configuration
+  const bool TRACE_ENABLED = false;       // Or "trace start" on the serial console
+  const bool TRACE_OUTPUT_BLOCKS = false; // Hundreds per frame, fills the ring in a few frames
+  
+  // Microbenchmark Configuration
+  const bool BENCHMARK_AT_BOOT = false;   // Prints JSON results, then starts normally
+  const uint32_t BENCHMARK_CASE_MS = 500; // Wall time per case
+  
+  // Asynchronous Log Configuration
+  const uint32_t LOG_DRAIN_INTERVAL = 20; // ms between log task wake-ups
+  
+  // Telemetry Configuration
+  const bool TELEMETRY_ENABLED = true;
+#ifdef HOST_BUILD
+  const IPAddress TELEMETRY_ADDRESS(127, 0, 0, 1);
+#else
+  const IPAddress TELEMETRY_ADDRESS(192, 168, 4, 255);  // Every client on the AP network
+#endif
+  const int TELEMETRY_PORT = 4211;
+  const uint32_t TELEMETRY_INTERVAL = 1000;
+  const bool SERIAL_STATISTICS = false;   // Always without telemetry; "stats" prints them on demand
+  
+  // Task Configuration: WiFi and lwIP run on core 0 next to the UDP task
+  const uint32_t UDP_TASK_STACK = 3072;
+  const uint32_t DISPLAY_TASK_STACK = 4096;
+  const uint32_t MONITOR_TASK_STACK = 3072;
+  const uint32_t LOG_TASK_STACK = 3072;
+  const BaseType_t UDP_TASK_CORE = 0;
+  const BaseType_t DISPLAY_TASK_CORE = 1;
+  const BaseType_t MONITOR_TASK_CORE = 0;
+  const BaseType_t LOG_TASK_CORE = 1;
+  const uint32_t TASK_SAMPLE_INTERVAL = 1000;
 }
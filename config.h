@@ -9,6 +9,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
+#include "wire_protocol.h"
 
 namespace Config {
   // Network Configuration
@@ -23,29 +24,128 @@ namespace Config {
   extern const uint16_t DISPLAY_WIDTH;
   extern const uint16_t DISPLAY_HEIGHT;
   extern const uint8_t DISPLAY_ROTATION;
+  extern const int16_t VIEWPORT_X;        // Video position on the panel, -1 to centre
+  extern const int16_t VIEWPORT_Y;
+  extern const uint16_t BORDER_COLOR;     // Around the video, painted when the viewport changes
+  
+  // Scaling Configuration
+  enum ScaleMode : uint8_t {
+    SCALE_OFF,        // Frames shown at their own size
+    SCALE_NEAREST,    // Pixels repeated
+    SCALE_BILINEAR    // 2-tap blend in each direction
+  };
+  extern const ScaleMode SCALE_MODE;      // Frames smaller than the panel are scaled up to fill it
+  extern const bool SCALE_KEEP_ASPECT;    // QVGA -> 426x320; otherwise stretched to 480x320
   
   // High-Speed Configuration
   extern const uint32_t MAX_FRAME_SIZE;
   extern const uint32_t FRAME_TIMEOUT;
+  extern const uint32_t FRAME_TIMEOUT_CHECK_INTERVAL;
   extern const uint32_t MIN_HEAP_SIZE;
   extern const uint32_t TARGET_FPS;
   extern const uint32_t MIN_RENDER_INTERVAL;
   extern const uint32_t FAST_RENDER_INTERVAL;
   
-  // Display Buffer Configuration
-  extern const uint32_t DISPLAY_BUFFER_SIZE;
-  extern const uint16_t STRIP_HEIGHT;
-  extern const uint16_t FAST_STRIP_HEIGHT;
+  // Strip Buffer Configuration
+  constexpr uint16_t STRIP_ROWS = 16;         // One MCU row: 16 lines for 4:2:0 JPEGs, 8 for 4:4:4
+  extern const uint32_t STRIP_BUFFER_SIZE;
+  extern const bool STRIP_DMA;                // Second strip, sent by DMA while the decoder fills the first
+  extern const uint32_t STRIP_DMA_HEAP_RESERVE;  // Free heap the second strip must leave
+  extern const bool DIRTY_BLOCKS;             // Send only the 16x16 blocks that changed since the last frame
   extern const uint16_t MAX_PACKETS;
+  extern const uint16_t PACKET_PAYLOAD_SIZE;
+  
+  // Frame Reassembly Configuration
+  constexpr uint8_t REASSEMBLY_SLOTS = 2;     // Frames assembled concurrently, a 35 KB buffer each
+  constexpr uint8_t PACKET_BITSET_WORDS = 16; // 512 packet bits, covers MAX_PACKETS
+  extern const bool ACCEPT_V1_PACKETS;        // Headerless-magic senders (wire v1)
+  
+  enum SlotEvictionPolicy : uint8_t {
+    EVICT_OLDEST,          // Drop the frame that started first
+    EVICT_LEAST_COMPLETE   // Drop the frame with the fewest packets received
+  };
+  extern const SlotEvictionPolicy SLOT_EVICTION_POLICY;
+  
+  // Forward Error Correction Configuration
+  constexpr uint8_t FEC_MAX_GROUPS = 8;          // Parity packets kept per frame
+  extern const bool FEC_ENABLED;
+  
+  // Retransmission (NACK) Configuration
+  extern const bool NACK_ENABLED;
+  extern const uint16_t NACK_MAX_MISSING;
+  extern const uint8_t NACK_MAX_ATTEMPTS;
+  extern const uint32_t NACK_STALL_TIME;
+  extern const uint32_t NACK_INITIAL_RTT;
+  
+  // Network Impairment (debug) Configuration
+  struct ImpairmentProfile {
+    const char* name;
+    float lossRate;         // Independent per-packet loss
+    float burstEnterRate;   // Gilbert-Elliott: good -> bad transition per packet
+    float burstExitRate;    // Gilbert-Elliott: bad -> good transition per packet
+    float burstLossRate;    // Loss while in the bad state
+    float reorderRate;      // Packets held back by reorderDelayUs
+    uint32_t reorderDelayUs;
+    float duplicateRate;
+    float truncateRate;     // Packets cut to a random shorter length
+    uint32_t jitterUs;      // Uniform extra delay, 0..jitterUs
+  };
+  constexpr uint8_t IMPAIRMENT_QUEUE_DEPTH = 16;  // Datagrams held for delay/reorder
+  extern const bool IMPAIRMENT_ENABLED;
+  extern const uint32_t IMPAIRMENT_SEED;
+  extern const ImpairmentProfile IMPAIRMENT_PROFILE;
+  
+  // Packet Capture Configuration
+  constexpr uint32_t CAPTURE_BUFFER_SIZE = 24 * 1024;  // Device RAM ring, newest datagrams kept
+  constexpr uint16_t CAPTURE_SNAP_LENGTH = 64;         // Device ring: bytes kept per datagram, 0 = all
+  extern const bool CAPTURE_ENABLED;                   // Start capturing at boot
+  extern const char* CAPTURE_FILE;                     // Host build: capture written here
+  
+  // Event Trace Configuration
+  constexpr uint16_t TRACE_EVENT_COUNT = 1024;  // Newest spans kept, 16 bytes each
+  extern const bool TRACE_ENABLED;              // Start tracing at boot
+  extern const bool TRACE_OUTPUT_BLOCKS;        // Also trace every decoder output callback
+  
+  // Microbenchmark Configuration
+  constexpr uint32_t BENCHMARK_FRAME_SIZE = 20000;  // Synthetic JPEG pushed through the hot paths
+  extern const bool BENCHMARK_AT_BOOT;              // Run the suite before the tasks start
+  extern const uint32_t BENCHMARK_CASE_MS;
+  
+  // Asynchronous Log Configuration
+  constexpr uint16_t LOG_RING_SIZE = 64;  // Messages queued per core
+  constexpr uint8_t LOG_MAX_ARGS = 4;     // Integer arguments per message
+  extern const uint32_t LOG_DRAIN_INTERVAL;
+  
+  // Telemetry Configuration
+  extern const bool TELEMETRY_ENABLED;
+  extern const IPAddress TELEMETRY_ADDRESS;   // Collector, or the AP broadcast address
+  extern const int TELEMETRY_PORT;
+  extern const uint32_t TELEMETRY_INTERVAL;   // ms between reports
+  extern const bool SERIAL_STATISTICS;        // Text statistics every 3 s as well
+  
+  // Task Configuration (stack sizes in bytes, as xTaskCreatePinnedToCore takes them on the ESP32)
+  extern const uint32_t UDP_TASK_STACK;
+  extern const uint32_t DISPLAY_TASK_STACK;
+  extern const uint32_t MONITOR_TASK_STACK;
+  extern const uint32_t LOG_TASK_STACK;
+  extern const BaseType_t UDP_TASK_CORE;
+  extern const BaseType_t DISPLAY_TASK_CORE;
+  extern const BaseType_t MONITOR_TASK_CORE;
+  extern const BaseType_t LOG_TASK_CORE;
+  extern const uint32_t TASK_SAMPLE_INTERVAL;     // ms between CPU/stack samples
+  constexpr uint8_t MAX_MONITORED_TASKS = 8;
+  constexpr uint8_t MAX_SYSTEM_TASKS = 32;        // uxTaskGetSystemState snapshot size
 }
 
 // Frame State Structure
 struct CompleteFrameState {
-  uint16_t frameId;
+  uint32_t frameId;
   uint16_t totalPackets;
   uint16_t receivedPackets;
   uint32_t totalSize;
   uint32_t startTime;
+  uint32_t firstPacketUs;   // micros() of the first packet received
+  uint32_t completeUs;      // micros() when reassembly finished
   bool isComplete;
   bool isValid;
   bool isRendering;
@@ -56,6 +156,8 @@ struct CompleteFrameState {
     receivedPackets = 0;
     totalSize = 0;
     startTime = 0;
+    firstPacketUs = 0;
+    completeUs = 0;
     isComplete = false;
     isValid = false;
     isRendering = false;
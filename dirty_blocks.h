@@ -0,0 +1,115 @@
+// dirty_blocks.h
+#ifndef DIRTY_BLOCKS_H
+#define DIRTY_BLOCKS_H
+
+#include "config.h"
+
+// Signatures of the blocks the panel shows, kept across frames so a strip
+// sends only the blocks that changed. The video is tracked as bands, one per
+// strip in the order a frame sends them, each cut into BLOCK_WIDTH-pixel
+// blocks as tall as the strip: 16x16 for 4:2:0 frames. A signature is a
+// 32-bit FNV-1a hash over pixel pairs; a collision leaves one block stale
+// until it changes again.
+class DirtyBlockMap {
+public:
+  static const uint8_t BLOCK_WIDTH = 16;
+  static const uint8_t MAX_BLOCKS = 64;     // Per band, the bits of a change mask
+  
+private:
+  uint32_t* signatures;     // bands x columns
+  int16_t* bandTop;         // Display row the band was last sent at, -1 when unknown
+  uint8_t* bandRows;
+  uint16_t columns;
+  uint16_t bands;
+  
+public:
+  DirtyBlockMap() : signatures(nullptr), bandTop(nullptr), bandRows(nullptr), columns(0), bands(0) {}
+  ~DirtyBlockMap() { cleanup(); }
+  
+  // Room for a width x height video sent in strips of at least minRows lines
+  bool initialize(uint16_t width, uint16_t height, uint8_t minRows);
+  void cleanup();
+  bool isReady() const { return signatures != nullptr; }
+  
+  // Forgets what the panel shows, so every block of the next frame is sent
+  void invalidate();
+  
+  // Hashes the blocks of a strip (rows lines, width pixels apart), stores the
+  // signatures for the band and returns the blocks that changed, bit n for
+  // block n. A band sent at another row or height, and blocks or bands
+  // beyond the map, always count as changed.
+  uint64_t update(uint16_t band, int16_t y, const uint16_t* strip, uint16_t width, uint16_t rows);
+  
+  static uint64_t allBlocks(uint16_t width) {
+    uint16_t count = blockCount(width);
+    return count >= MAX_BLOCKS ? ~0ULL : (1ULL << count) - 1;
+  }
+  static uint16_t blockCount(uint16_t width) { return (width + BLOCK_WIDTH - 1) / BLOCK_WIDTH; }
+  static uint32_t signature(const uint16_t* pixels, uint16_t stride, uint16_t w, uint16_t rows);
+};
+
+#endif // DIRTY_BLOCKS_H
+
+// dirty_blocks.cpp
+#include "dirty_blocks.h"
+
+bool DirtyBlockMap::initialize(uint16_t width, uint16_t height, uint8_t minRows) {
+  columns = min(blockCount(width), (uint16_t)MAX_BLOCKS);
+  bands = (height + minRows - 1) / minRows;
+  signatures = (uint32_t*)heap_caps_malloc(columns * bands * 4, MALLOC_CAP_8BIT);
+  bandTop = (int16_t*)heap_caps_malloc(bands * 2, MALLOC_CAP_8BIT);
+  bandRows = (uint8_t*)heap_caps_malloc(bands, MALLOC_CAP_8BIT);
+  if (!signatures || !bandTop || !bandRows) {
+    cleanup();
+    return false;
+  }
+  invalidate();
+  return true;
+}
+
+void DirtyBlockMap::cleanup() {
+  if (signatures) heap_caps_free(signatures);
+  if (bandTop) heap_caps_free(bandTop);
+  if (bandRows) heap_caps_free(bandRows);
+  signatures = nullptr;
+  bandTop = nullptr;
+  bandRows = nullptr;
+}
+
+void DirtyBlockMap::invalidate() {
+  if (!isReady()) return;
+  for (uint16_t band = 0; band < bands; band++) bandTop[band] = -1;
+}
+
+uint32_t DirtyBlockMap::signature(const uint16_t* pixels, uint16_t stride, uint16_t w, uint16_t rows) {
+  uint32_t hash = 0x811C9DC5;
+  for (uint16_t row = 0; row < rows; row++, pixels += stride) {
+    uint16_t x = 0;
+    for (; x + 1 < w; x += 2) hash = (hash ^ (pixels[x] | ((uint32_t)pixels[x + 1] << 16))) * 0x01000193;
+    if (x < w) hash = (hash ^ pixels[x]) * 0x01000193;
+  }
+  return hash;
+}
+
+uint64_t DirtyBlockMap::update(uint16_t band, int16_t y, const uint16_t* strip, uint16_t width, uint16_t rows) {
+  uint64_t all = allBlocks(width);
+  if (!isReady() || band >= bands) return all;
+  
+  // Same place and height as last time, or nothing to compare against
+  bool known = bandTop[band] == y && bandRows[band] == rows;
+  bandTop[band] = y;
+  bandRows[band] = rows;
+  
+  uint64_t changed = known ? 0 : all;
+  uint32_t* stored = signatures + band * columns;
+  uint16_t count = min(blockCount(width), columns);
+  for (uint16_t block = 0; block < count; block++) {
+    uint16_t left = block * BLOCK_WIDTH;
+    uint32_t hash = signature(strip + left, width, min((uint16_t)BLOCK_WIDTH, (uint16_t)(width - left)), rows);
+    if (hash != stored[block]) changed |= 1ULL << block;
+    stored[block] = hash;
+  }
+  
+  // Blocks past the map's columns are never tracked
+  return changed | (all & ~allBlocks(count * BLOCK_WIDTH));
+}
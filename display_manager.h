@@ -3,14 +3,65 @@
 #define DISPLAY_MANAGER_H
 
 #include "config.h"
+#include "frame_scaler.h"
+#include "dirty_blocks.h"
 
 class DisplayManager {
 private:
   TFT_eSPI tft;
-  uint16_t* displayBuffer;
-  bool displayBufferEnabled;
+  uint16_t* strips[2];      // One MCU row of the image each, STRIP_ROWS x stripWidth pixels
+  uint8_t fillStrip;        // Strip the decoder writes; with DMA the other may be on the wire
+  bool dmaEnabled;
+  int16_t stripX;           // Display column of the strip's first pixel
+  uint16_t stripWidth;      // Image width clipped to the display, the strip's row stride
+  int16_t stripY;           // Display row of the strip's first line
+  uint16_t stripRows;       // Lines holding pixels; 0 when the strip is empty
+  uint32_t transferTime;    // µs the render path spent on pixel transfers this frame
+  uint32_t renderFrameId;   // Frame being decoded, for the trace
   
-  DisplayManager() : displayBuffer(nullptr), displayBufferEnabled(false) {}
+  // Scaling: the decoder fills scaleSource at the image's own width and the
+  // scaler turns each MCU row into output rows in strips[fillStrip]
+  FrameScaler scaler;
+  uint16_t* scaleSource;
+  bool scaling;             // This frame goes through the scaler
+  int16_t outputY;          // Display row of the next scaled strip
+  uint16_t outputRows;      // Scaled rows waiting in strips[fillStrip]
+  
+  // Delta updates: strips send only the blocks that changed since the last frame
+  DirtyBlockMap dirtyBlocks;
+  uint16_t stripBand;       // Strips sent so far this frame, the band of the next
+  uint32_t blocksChecked;
+  uint32_t blocksChanged;
+  uint32_t bytesSkipped;
+  
+  // Video rectangle the borders were last painted around
+  int16_t viewX;
+  int16_t viewY;
+  uint16_t viewWidth;
+  uint16_t viewHeight;
+  bool screenClear;         // Whole panel in BORDER_COLOR since clearScreen()
+  
+  // DMA overlap for the current frame
+  bool dmaPending;
+  uint32_t dmaStart;
+  uint32_t dmaBusyTime;     // Queue to observed completion, summed over strips
+  uint32_t dmaWaitTime;     // Part of it the render path spent blocked in dmaWait
+  
+  DisplayManager() : fillStrip(0), dmaEnabled(false), stripX(0), stripWidth(0), stripY(0), 
+                     stripRows(0), transferTime(0), renderFrameId(0), scaleSource(nullptr), 
+                     scaling(false), outputY(0), outputRows(0), stripBand(0), blocksChecked(0), 
+                     blocksChanged(0), bytesSkipped(0), viewX(0), viewY(0), viewWidth(0), 
+                     viewHeight(0), screenClear(false), dmaPending(false), dmaStart(0), dmaBusyTime(0), 
+                     dmaWaitTime(0) {
+    strips[0] = strips[1] = nullptr;
+  }
+  
+  void waitForDma();
+  void sendStrip(int16_t x, int16_t y, uint16_t w, uint16_t rows);
+  void sendChangedBlocks(int16_t x, int16_t y, uint16_t w, uint16_t rows, uint64_t changed);
+  void scaleStrip();
+  void sendScaledRows();
+  void setViewport(int16_t x, int16_t y, uint16_t w, uint16_t h);
   
 public:
   static DisplayManager& getInstance() {
@@ -20,17 +71,33 @@ public:
   
   bool initialize();
   void cleanup();
-  bool initializeDisplayBuffer();
+  bool initializeStripBuffer();
+  // Setup only, before the display task starts: neither is synchronised with it
   void showStartupMessage(const char* message);
   void clearScreen();
   TFT_eSPI& getTft() { return tft; }
-  uint16_t* getDisplayBuffer() { return displayBuffer; }
-  bool isDisplayBufferEnabled() const { return displayBufferEnabled; }
+  bool isStripBufferEnabled() const { return strips[0] != nullptr; }
+  bool isStripDmaEnabled() const { return dmaEnabled; }
+  bool isScalerEnabled() const { return scaleSource != nullptr; }
+  bool isDeltaEnabled() const { return dirtyBlocks.isReady(); }
   bool renderFrame(uint8_t* frameData, uint32_t size);
   
   // High-speed rendering methods
-  bool renderFrameHighSpeed(uint8_t* frameData, uint32_t size);
-  void fastStripTransfer();
+  bool renderFrameHighSpeed(uint8_t* frameData, uint32_t size, uint32_t frameId = 0);
+  
+  // Strip pipeline: the decoder callback copies MCU blocks into the strip and
+  // flushes it to the panel in one transfer once it spans the image width.
+  // With DMA the flush only queues the strip and the decoder moves on to the
+  // other one. Every frame is bracketed by beginStrips() and endStrips().
+  // A scaled frame fills the strip at source coordinates and width, and the
+  // flush sends the scaled rows into the viewport instead.
+  void beginStrips(int16_t x, uint16_t width, bool scaled = false);
+  bool addToStrip(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t sourceWidth, 
+                  const uint16_t* bitmap);
+  void flushStrip();
+  void endStrips();
+  void pushBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t sourceWidth, uint16_t* bitmap);
+  uint32_t getRenderFrameId() const { return renderFrameId; }
   
   ~DisplayManager() { cleanup(); }
 };
@@ -42,6 +109,8 @@ bool highSpeedTftOutput(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t*
 
 // display_manager.cpp
 #include "display_manager.h"
+#include "performance_monitor.h"
+#include "trace_recorder.h"
 
 bool DisplayManager::initialize() {
   Serial.println("Initializing display...");
@@ -59,36 +128,78 @@ bool DisplayManager::initialize() {
   TJpgDec.setCallback(highSpeedTftOutput);
   Serial.println("High-speed JPEG decoder ready");
   
-  // Try to initialize display buffer
-  initializeDisplayBuffer();
-  
+  // The strip buffers come later, from what the frame processor leaves
   return true;
 }
 
-bool DisplayManager::initializeDisplayBuffer() {
-  uint32_t availableHeap = ESP.getFreeHeap();
-  displayBufferEnabled = (availableHeap > Config::DISPLAY_BUFFER_SIZE + 60000);
+bool DisplayManager::initializeStripBuffer() {
+  // DMA-capable memory is internal RAM, which the per-MCU copies want anyway
+  for (uint8_t i = 0; i < 2; i++) {
+    strips[i] = (uint16_t*)heap_caps_malloc(Config::STRIP_BUFFER_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    if (strips[i]) memset(strips[i], 0, Config::STRIP_BUFFER_SIZE);
+  }
   
-  if (displayBufferEnabled) {
-    displayBuffer = (uint16_t*)heap_caps_malloc(Config::DISPLAY_BUFFER_SIZE, MALLOC_CAP_8BIT);
-    if (displayBuffer) {
-      memset(displayBuffer, 0, Config::DISPLAY_BUFFER_SIZE);
-      Serial.printf("Display buffer allocated: %d KB\n", Config::DISPLAY_BUFFER_SIZE/1024);
+  if (!strips[0]) {
+    // Still works: every MCU block goes to the panel on its own
+    cleanup();
+    Serial.println("Strip buffer allocation failed, pushing MCU blocks directly");
+    return false;
+  }
+  
+  // The scaler, when configured, comes before DMA: it changes what is shown
+  if (Config::SCALE_MODE != Config::SCALE_OFF) {
+    scaleSource = (uint16_t*)heap_caps_malloc(Config::STRIP_BUFFER_SIZE, MALLOC_CAP_8BIT);
+    if (scaleSource && scaler.initialize()) {
+      Serial.printf("Scaler ready: %s, %s\n", Config::SCALE_MODE == Config::SCALE_NEAREST ? "nearest" : "bilinear",
+                   Config::SCALE_KEEP_ASPECT ? "aspect kept" : "stretched");
+    } else {
+      if (scaleSource) heap_caps_free(scaleSource);
+      scaleSource = nullptr;
+      Serial.println("Scaler allocation failed, frames shown at their own size");
+    }
+  }
+  
+  // Delta updates: bands as short as an 8-line MCU row
+  if (Config::DIRTY_BLOCKS) {
+    if (dirtyBlocks.initialize(Config::DISPLAY_WIDTH, Config::DISPLAY_HEIGHT, 8)) {
+      Serial.printf("Dirty blocks: %dx%d signatures, only changed blocks sent\n", 
+                   DirtyBlockMap::blockCount(Config::DISPLAY_WIDTH), (Config::DISPLAY_HEIGHT + 7) / 8);
     } else {
-      displayBufferEnabled = false;
-      Serial.println("Display buffer allocation failed");
+      Serial.println("Dirty block map allocation failed, every block sent");
     }
   }
   
-  Serial.printf("Display buffer: %s\n", displayBufferEnabled ? "ENABLED" : "DISABLED");
+  // Double buffering needs both strips, heap to spare for WiFi and the tasks,
+  // and the SPI DMA channel
+  bool heapToSpare = ESP.getFreeHeap() >= Config::STRIP_DMA_HEAP_RESERVE;
+  dmaEnabled = Config::STRIP_DMA && strips[1] && heapToSpare && tft.initDMA();
+  if (!dmaEnabled && strips[1]) {
+    heap_caps_free(strips[1]);
+    strips[1] = nullptr;
+  }
+  
+  Serial.printf("Strip buffers allocated: %d x %d KB (%d rows), DMA %s\n", dmaEnabled ? 2 : 1, 
+               Config::STRIP_BUFFER_SIZE/1024, Config::STRIP_ROWS, dmaEnabled ? "ENABLED" : "DISABLED");
   return true;
 }
 
 void DisplayManager::cleanup() {
-  if (displayBuffer) {
-    heap_caps_free(displayBuffer);
-    displayBuffer = nullptr;
+  if (dmaEnabled) {
+    tft.deInitDMA();
+    dmaEnabled = false;
   }
+  for (uint8_t i = 0; i < 2; i++) {
+    if (strips[i]) {
+      heap_caps_free(strips[i]);
+      strips[i] = nullptr;
+    }
+  }
+  if (scaleSource) {
+    heap_caps_free(scaleSource);
+    scaleSource = nullptr;
+  }
+  scaler.cleanup();
+  dirtyBlocks.cleanup();
 }
 
 void DisplayManager::showStartupMessage(const char* message) {
@@ -101,89 +212,277 @@ void DisplayManager::showStartupMessage(const char* message) {
 }
 
 void DisplayManager::clearScreen() {
-  tft.fillScreen(TFT_BLACK);
+  tft.fillScreen(Config::BORDER_COLOR);
+  screenClear = true;
+  viewWidth = viewHeight = 0;   // The next frame repaints and resends every block
 }
 
-bool DisplayManager::renderFrameHighSpeed(uint8_t* frameData, uint32_t size) {
+// Paints everything outside the video rectangle, only when it moves or changes
+// size; frames then push the rectangle alone
+void DisplayManager::setViewport(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+  if (x == viewX && y == viewY && w == viewWidth && h == viewHeight) return;
+  
+  if (!screenClear) {
+    uint16_t right = x + w;
+    uint16_t bottom = y + h;
+    tft.fillRect(0, 0, Config::DISPLAY_WIDTH, y, Config::BORDER_COLOR);
+    tft.fillRect(0, bottom, Config::DISPLAY_WIDTH, Config::DISPLAY_HEIGHT - bottom, Config::BORDER_COLOR);
+    tft.fillRect(0, y, x, h, Config::BORDER_COLOR);
+    tft.fillRect(right, y, Config::DISPLAY_WIDTH - right, h, Config::BORDER_COLOR);
+  }
+  
+  // The signatures describe the old layout, or a panel cleared since
+  dirtyBlocks.invalidate();
+  
+  Serial.printf("Viewport: %dx%d at (%d, %d)\n", w, h, x, y);
+  viewX = x;
+  viewY = y;
+  viewWidth = w;
+  viewHeight = h;
+  screenClear = false;
+}
+
+bool DisplayManager::renderFrameHighSpeed(uint8_t* frameData, uint32_t size, uint32_t frameId) {
   if (!frameData || size == 0) return false;
   
-  uint32_t renderStart = micros();
+  // The viewport and the strip's row stride follow from the image size,
+  // known before the first block
+  uint16_t imageWidth = 0;
+  uint16_t imageHeight = 0;
+  if (TJpgDec.getJpgSize(&imageWidth, &imageHeight, frameData, size) != JDR_OK) return false;
+  uint16_t width = min(imageWidth, Config::DISPLAY_WIDTH);
+  uint16_t height = min(imageHeight, Config::DISPLAY_HEIGHT);
   
-  // Clear display buffer if available
-  if (displayBuffer) {
-    memset(displayBuffer, 0, Config::DISPLAY_BUFFER_SIZE);
+  // Frames smaller than the panel are scaled up to fill it when configured
+  bool scaled = false;
+  if (scaleSource && imageWidth <= Config::DISPLAY_WIDTH && imageHeight <= Config::DISPLAY_HEIGHT) {
+    uint16_t scaledWidth, scaledHeight;
+    FrameScaler::fitSize(imageWidth, imageHeight, Config::DISPLAY_WIDTH, Config::DISPLAY_HEIGHT, 
+                         Config::SCALE_KEEP_ASPECT, scaledWidth, scaledHeight);
+    scaled = scaler.configure(Config::SCALE_MODE, imageWidth, imageHeight, scaledWidth, scaledHeight);
+    if (scaled) {
+      width = scaledWidth;
+      height = scaledHeight;
+    }
   }
   
-  // High-speed JPEG rendering
+  int16_t x = Config::VIEWPORT_X < 0 ? (Config::DISPLAY_WIDTH - width) / 2 : 
+              min(Config::VIEWPORT_X, (int16_t)(Config::DISPLAY_WIDTH - width));
+  int16_t y = Config::VIEWPORT_Y < 0 ? (Config::DISPLAY_HEIGHT - height) / 2 : 
+              min(Config::VIEWPORT_Y, (int16_t)(Config::DISPLAY_HEIGHT - height));
+  setViewport(x, y, width, height);
+  
+  // High-speed JPEG rendering; the decoder's callback pushes pixels itself,
+  // a strip or a block at a time, and adds the time it waited to transferTime
+  transferTime = 0;
+  renderFrameId = frameId;
+  // A scaled frame is decoded at source coordinates, the scaler places it
+  beginStrips(scaled ? 0 : x, scaled ? imageWidth : width, scaled);
+  uint32_t decodeStart = micros();
   TJpgDec.setJpgScale(1);
-  bool success = TJpgDec.drawJpg(0, 0, frameData, size);
+  bool success = TJpgDec.drawJpg(scaled ? 0 : x, scaled ? 0 : y, frameData, size) == JDR_OK;
+  endStrips();
+  uint32_t decodeTime = micros() - decodeStart - transferTime;
+  TraceRecorder::getInstance().record(TraceRecorder::TRACE_DECODE, decodeStart, frameId);
+  
+  if (success) {
+    PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+    pm.recordLatency(PerformanceMonitor::LATENCY_DECODE, decodeTime);
+    pm.recordLatency(PerformanceMonitor::LATENCY_TRANSFER, transferTime);
+    if (dmaEnabled) pm.recordStripOverlap(dmaBusyTime, dmaWaitTime);
+    if (dirtyBlocks.isReady()) pm.recordBlockDelta(blocksChanged, blocksChecked, bytesSkipped);
+  }
   
-  if (success && displayBuffer) {
-    fastStripTransfer();
+  return success;
+}
+
+void DisplayManager::beginStrips(int16_t x, uint16_t width, bool scaled) {
+  stripX = x;
+  stripWidth = width;
+  stripRows = 0;
+  stripBand = 0;
+  blocksChecked = blocksChanged = bytesSkipped = 0;
+  scaling = scaled && scaleSource;
+  if (scaling) {
+    scaler.beginFrame();
+    outputY = viewY;
+    outputRows = 0;
   }
+  dmaBusyTime = dmaWaitTime = 0;
   
-  uint32_t renderTime = micros() - renderStart;
+  // DMA transfers need the bus held for the whole frame
+  if (dmaEnabled) tft.startWrite();
+}
+
+// Returns true once the strip spans the image width and should be flushed
+bool DisplayManager::addToStrip(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t sourceWidth, 
+                                const uint16_t* bitmap) {
+  // A block from another MCU row: push what is left of the previous one first
+  if (stripRows && y != stripY) flushStrip();
+  if (!stripRows) stripY = y;
+  int16_t column = x - stripX;
+  if (column < 0 || column >= stripWidth) return stripRows > 0;
+  if (column + w > stripWidth) w = stripWidth - column;
   
-  if (success) {
-    Serial.printf("Frame rendered in %d µs\n", renderTime);
+  uint16_t* strip = scaling ? scaleSource : strips[fillStrip];
+  for (uint16_t row = 0; row < h; row++) {
+    memcpy(&strip[row * stripWidth + column], &bitmap[row * sourceWidth], w << 1);
   }
+  if (h > stripRows) stripRows = h;
   
-  return success;
+  return column + w >= stripWidth;
 }
 
-void DisplayManager::fastStripTransfer() {
-  if (!displayBuffer) return;
+void DisplayManager::flushStrip() {
+  if (!stripRows) return;
+  if (scaling) {
+    scaleStrip();
+  } else {
+    sendStrip(stripX, stripY, stripWidth, stripRows);
+  }
+  stripRows = 0;
+}
+
+// Sends rows of strips[fillStrip], w pixels apart: the whole strip when every
+// block changed, nothing when none did, the changed runs otherwise
+void DisplayManager::sendStrip(int16_t x, int16_t y, uint16_t w, uint16_t rows) {
+  TraceScope trace(TraceRecorder::TRACE_STRIP_TRANSFER, renderFrameId);
+  uint32_t transferStart = micros();
   
-  tft.startWrite();
+  uint64_t all = DirtyBlockMap::allBlocks(w);
+  uint64_t changed = all;
+  if (dirtyBlocks.isReady()) {
+    changed = dirtyBlocks.update(stripBand++, y, strips[fillStrip], w, rows);
+    blocksChecked += DirtyBlockMap::blockCount(w);
+    blocksChanged += __builtin_popcountll(changed);
+  }
   
-  // Use smaller strips for higher refresh rate
-  uint16_t stripHeight = (Config::TARGET_FPS > 45) ? Config::FAST_STRIP_HEIGHT : Config::STRIP_HEIGHT;
+  if (changed != all) {
+    sendChangedBlocks(x, y, w, rows, changed);
+  } else if (dmaEnabled) {
+    // The previous strip must be off the wire before this one is queued; the
+    // decoder then fills the other strip while DMA clocks this one out
+    waitForDma();
+    tft.pushImageDMA(x, y, w, rows, strips[fillStrip]);
+    dmaStart = micros();
+    dmaPending = true;
+    fillStrip ^= 1;
+  } else {
+    // One address window and one burst for the whole MCU row
+    tft.startWrite();
+    tft.setAddrWindow(x, y, w, rows);
+    tft.pushPixels(strips[fillStrip], w * rows);
+    tft.endWrite();
+  }
   
-  for (uint16_t y = 0; y < Config::DISPLAY_HEIGHT; y += stripHeight) {
-    uint16_t currentStripHeight = min((uint16_t)stripHeight, (uint16_t)(Config::DISPLAY_HEIGHT - y));
-    
-    tft.setAddrWindow(0, y, Config::DISPLAY_WIDTH, currentStripHeight);
-    
-    uint32_t pixelOffset = y * Config::DISPLAY_WIDTH;
-    uint32_t pixelsToSend = currentStripHeight * Config::DISPLAY_WIDTH;
-    
-    tft.pushPixels(&displayBuffer[pixelOffset], pixelsToSend);
+  transferTime += micros() - transferStart;
+}
+
+// One address window per run of neighbouring changed blocks. Blocking even
+// with DMA: a run's rows are not contiguous in the strip, and the strip is
+// free again as soon as this returns.
+void DisplayManager::sendChangedBlocks(int16_t x, int16_t y, uint16_t w, uint16_t rows, uint64_t changed) {
+  uint16_t blocks = DirtyBlockMap::blockCount(w);
+  uint32_t sent = 0;
+  if (changed) {
+    waitForDma();
+    if (!dmaEnabled) tft.startWrite();
+  }
+  
+  for (uint16_t block = 0; block < blocks && changed >> block; ) {
+    if (!((changed >> block) & 1)) {
+      block++;
+      continue;
+    }
+    uint16_t left = block * DirtyBlockMap::BLOCK_WIDTH;
+    while (block < blocks && ((changed >> block) & 1)) block++;
+    uint16_t runWidth = min((uint16_t)(block * DirtyBlockMap::BLOCK_WIDTH), w) - left;
     
-    // Minimal yielding for maximum speed
-    if (y % (stripHeight * 4) == 0) {
-      taskYIELD();
+    tft.setAddrWindow(x + left, y, runWidth, rows);
+    for (uint16_t row = 0; row < rows; row++) {
+      tft.pushPixels(&strips[fillStrip][row * w + left], runWidth);
     }
+    sent += runWidth * rows;
+  }
+  
+  if (changed && !dmaEnabled) tft.endWrite();
+  bytesSkipped += (w * rows - sent) * 2;
+}
+
+// Turns the decoded MCU row into the output rows it completes, sending every
+// output strip that fills up on the way. The scaling itself counts as decode.
+void DisplayManager::scaleStrip() {
+  uint16_t width = scaler.getOutputWidth();
+  while (true) {
+    outputRows += scaler.scaleRows(scaleSource, stripY, stripRows, strips[fillStrip] + outputRows * width, 
+                                   Config::STRIP_ROWS - outputRows);
+    if (outputRows < Config::STRIP_ROWS) break;
+    sendScaledRows();
   }
+}
+
+void DisplayManager::sendScaledRows() {
+  sendStrip(viewX, outputY, scaler.getOutputWidth(), outputRows);
+  outputY += outputRows;
+  outputRows = 0;
+}
+
+void DisplayManager::endStrips() {
+  flushStrip();   // A last row the decoder left short
+  if (scaling && outputRows) sendScaledRows();
+  if (!dmaEnabled) return;
   
+  uint32_t waitStart = micros();
+  waitForDma();
   tft.endWrite();
+  transferTime += micros() - waitStart;
+}
+
+// The busy time is exact when the wait blocked; when the transfer had already
+// finished it is an upper bound, but then it was fully hidden anyway
+void DisplayManager::waitForDma() {
+  if (!dmaPending) return;
+  uint32_t waitStart = micros();
+  tft.dmaWait();
+  uint32_t now = micros();
+  dmaWaitTime += now - waitStart;
+  dmaBusyTime += now - dmaStart;
+  dmaPending = false;
+}
+
+// A block that does not go through the strip, one transfer of its own
+void DisplayManager::pushBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t sourceWidth, 
+                               uint16_t* bitmap) {
+  uint32_t pushStart = micros();
+  waitForDma();
+  if (w == sourceWidth) {
+    tft.pushImage(x, y, w, h, bitmap);
+  } else {
+    for (uint16_t row = 0; row < h; row++) {
+      tft.pushImage(x, y + row, w, 1, &bitmap[row * sourceWidth]);
+    }
+  }
+  transferTime += micros() - pushStart;
 }
 
 // TJpg callback function implementation
 bool highSpeedTftOutput(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
   DisplayManager& dm = DisplayManager::getInstance();
-  uint16_t* displayBuffer = dm.getDisplayBuffer();
   
   if (!bitmap || y >= Config::DISPLAY_HEIGHT || x >= Config::DISPLAY_WIDTH) return 0;
+  uint32_t blockStart = Config::TRACE_OUTPUT_BLOCKS ? micros() : 0;
   
-  // Fast bounds checking
+  // Fast bounds checking; rows of the bitmap stay sourceWidth apart
+  uint16_t sourceWidth = w;
   if (x + w > Config::DISPLAY_WIDTH) w = Config::DISPLAY_WIDTH - x;
   if (y + h > Config::DISPLAY_HEIGHT) h = Config::DISPLAY_HEIGHT - y;
   
   if (w > 0 && h > 0) {
-    if (displayBuffer) {
-      // High-speed buffer copy with DMA-aligned access
-      for (uint16_t row = 0; row < h; row++) {
-        uint32_t dstOffset = (y + row) * Config::DISPLAY_WIDTH + x;
-        uint32_t srcOffset = row * w;
-        
-        if (dstOffset + w <= Config::DISPLAY_WIDTH * Config::DISPLAY_HEIGHT) {
-          // Fast memcpy for performance
-          memcpy(&displayBuffer[dstOffset], &bitmap[srcOffset], w << 1);
-        }
-      }
+    if (dm.isStripBufferEnabled() && h <= Config::STRIP_ROWS) {
+      if (dm.addToStrip(x, y, w, h, sourceWidth, bitmap)) dm.flushStrip();
     } else {
-      // Direct high-speed rendering
-      dm.getTft().pushImage(x, y, w, h, bitmap);
+      // Direct rendering, one MCU block per transfer
+      dm.pushBlock(x, y, w, h, sourceWidth, bitmap);
     }
   }
   
@@ -194,5 +493,9 @@ bool highSpeedTftOutput(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t*
     callCount = 0;
   }
   
+  if (Config::TRACE_OUTPUT_BLOCKS) {
+    TraceRecorder::getInstance().record(TraceRecorder::TRACE_OUTPUT_BLOCK, blockStart, dm.getRenderFrameId());
+  }
+  
   return 1;
 }
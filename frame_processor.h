@@ -3,22 +3,123 @@
 #define FRAME_PROCESSOR_H
 
 #include "config.h"
+#include "packet_bitset.h"
+#include <atomic>
+
+// Compressed frame buffer plus the metadata of the frame it holds. Buffers
+// rotate between the reassembly slots, the ready mailbox and the decoder.
+struct FrameDescriptor {
+  uint8_t* data;
+  uint32_t frameId;
+  uint16_t totalPackets;
+  uint32_t totalSize;
+  uint32_t startTime;
+  uint32_t firstPacketUs;
+  uint32_t completeUs;
+};
+
+// Reassembly slot: one in-flight frame with its own buffer and packet tracking
+struct FrameSlot {
+  CompleteFrameState state;
+  uint8_t bufferIndex;    // Frame buffer this slot is currently assembling into
+  uint8_t* buffer;
+  PacketBitset received;
+  
+  // XOR parity packets, one per FEC group, stored as received (header + data).
+  // Allocated with the slot's first parity packet, so FEC-less streams pay nothing.
+  uint8_t* parity;
+  uint8_t parityReceived; // Bit per FEC group
+  uint8_t fecGroupSize;   // Data packets per group, announced by the parity packets
+  
+  // Selective retransmission
+  uint32_t lastPacketTime;
+  uint32_t nackTime;      // When the outstanding request was sent, 0 if none
+  uint8_t nackAttempts;
+  
+  bool isFree() const { return state.receivedPackets == 0 && parityReceived == 0; }
+};
+
+// Where one packet's payload lands inside a reassembly slot
+struct PacketPlacement {
+  FrameSlot* slot;
+  uint32_t frameId;
+  uint16_t packetIndex;
+  uint32_t payloadSize;
+  bool isParity;
+};
 
 class FrameProcessor {
 private:
-  uint8_t* frameBuffer;
-  uint8_t* assemblyBuffer;
-  bool* packetReceived;
-  CompleteFrameState currentFrame;
+  // One buffer per reassembly slot, plus the ready and decoding buffers: four
+  // MAX_FRAME_SIZE buffers with two slots, about what a WROOM can spare
+  static const uint8_t FRAME_BUFFER_COUNT = Config::REASSEMBLY_SLOTS + 2;
+  static const uint8_t FRESH_FRAME = 0x80;
+  static const uint32_t PARITY_AREA_SIZE = Config::FEC_MAX_GROUPS * WireProto::PARITY_PAYLOAD_SIZE;
+  
+  // Packets parity rebuilt recently. When one's original still turns up it was
+  // reordered rather than lost, and the rebuild is not counted as a recovery.
+  static const uint8_t REBUILT_HISTORY = 16;
+  struct RebuiltPacket {
+    uint32_t frameId;
+    uint16_t packetIndex;   // NO_PACKET when the entry is unused
+  };
+  static const uint16_t NO_PACKET = 0xFFFF;
+  
+  FrameDescriptor frameBuffers[FRAME_BUFFER_COUNT];
+  FrameSlot slots[Config::REASSEMBLY_SLOTS];     // UDP task only
+  uint32_t lastReadyFrameId;                      // UDP task only
+  uint32_t retransmitRtt;                         // UDP task only, ms
+  RebuiltPacket rebuiltPackets[REBUILT_HISTORY];  // UDP task only
+  uint8_t rebuiltNext;                            // UDP task only
+  uint8_t decodingBuffer;                         // Display task only
+  CompleteFrameState currentFrame;                // Display task only
+  
+  // Triple-buffer mailbox: index of the newest complete frame, with FRESH_FRAME
+  // set until the display task swaps it out. Publishing and taking a frame are
+  // both a single atomic exchange of buffer indices.
+  std::atomic<uint8_t> readyBuffer;
   
-  SemaphoreHandle_t frameMutex;
   SemaphoreHandle_t displayMutex;
   
-  FrameProcessor() : frameBuffer(nullptr), assemblyBuffer(nullptr), 
-                    packetReceived(nullptr), frameMutex(nullptr), displayMutex(nullptr) {
+  FrameProcessor() : lastReadyFrameId(0), retransmitRtt(Config::NACK_INITIAL_RTT), rebuiltNext(0),
+                    decodingBuffer(0), readyBuffer(0), displayMutex(nullptr) {
+    for (uint8_t i = 0; i < FRAME_BUFFER_COUNT; i++) {
+      frameBuffers[i].data = nullptr;
+    }
+    for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+      slots[i].state.reset();
+      slots[i].bufferIndex = i;
+      slots[i].buffer = nullptr;
+      slots[i].received.clear();
+      slots[i].parity = nullptr;
+      slots[i].parityReceived = 0;
+      slots[i].fecGroupSize = 0;
+      slots[i].nackTime = 0;
+      slots[i].nackAttempts = 0;
+    }
+    for (uint8_t i = 0; i < REBUILT_HISTORY; i++) {
+      rebuiltPackets[i].packetIndex = NO_PACKET;
+    }
     currentFrame.reset();
   }
   
+  // Slot management (UDP task only)
+  bool isStaleFrame(uint32_t frameId) const;
+  FrameSlot* findSlot(uint32_t frameId);
+  FrameSlot* allocateSlot(uint32_t frameId);
+  FrameSlot* selectEvictionVictim();
+  void publishSlot(FrameSlot& slot);
+  void releaseSlot(FrameSlot& slot);
+  
+  // Forward error correction (UDP task only)
+  bool allocateParity(FrameSlot& slot);
+  bool commitParity(FrameSlot& slot, const PacketPlacement& placement);
+  void recoverPacket(FrameSlot& slot, uint16_t group);
+  bool wasRebuilt(uint32_t frameId, uint16_t packetIndex);
+  
+  // Frame handoff (display task only)
+  FrameDescriptor* acquireFrame();
+  
 public:
   static FrameProcessor& getInstance() {
     static FrameProcessor instance;
@@ -28,11 +129,20 @@ public:
   bool initialize();
   void cleanup();
   bool processPacket(uint8_t* packetData, int size);
-  bool isFrameComplete() const { return currentFrame.isComplete; }
+  
+  // Zero-copy packet path: reserve the payload's final position from the header,
+  // let the caller read the payload straight into it, then commit. The caller
+  // checks that the datagram really carried placement.payloadSize bytes.
+  uint8_t* reservePayload(const WireProto::PacketHeader& header, PacketPlacement& placement);
+  bool commitPayload(const PacketPlacement& placement);
+  bool isFrameComplete() const { 
+    return (readyBuffer.load(std::memory_order_acquire) & FRESH_FRAME) != 0; 
+  }
   bool isFrameValid() const { return currentFrame.isValid; }
   bool isFrameRendering() const { return currentFrame.isRendering; }
-  uint8_t* getFrameBuffer() { return frameBuffer; }
+  uint8_t* getFrameBuffer() { return frameBuffers[decodingBuffer].data; }
   CompleteFrameState& getCurrentFrame() { return currentFrame; }
+  uint8_t getActiveSlots() const;
   
   // Frame processing methods
   bool assembleCompleteFrame();
@@ -40,9 +150,13 @@ public:
   void handleFrameTimeout();
   void resetCurrentFrame();
   
+  // Retransmission: builds one missing-packet request (NACK) for a frame that
+  // stalled a few packets short and can still be repaired before its timeout.
+  // Returns the request size, 0 when nothing needs asking for.
+  int buildRetransmitRequest(uint8_t* request, int maxSize);
+  uint32_t getRetransmitRtt() const { return retransmitRtt; }
+  
   // Mutex management
-  bool lockFrame(uint32_t timeoutMs = 10);
-  void unlockFrame();
   bool lockDisplay(uint32_t timeoutMs = 15);
   void unlockDisplay();
   
@@ -54,15 +168,25 @@ public:
 // frame_processor.cpp
 #include "frame_processor.h"
 #include "performance_monitor.h"
+#include "trace_recorder.h"
+#include "async_logger.h"
+
+// Packets for frames this far behind the last displayed one are late stragglers
+// rather than a restarted camera, and must not claim a reassembly slot.
+static const int32_t STALE_FRAME_WINDOW = 64;
 
 bool FrameProcessor::initialize() {
   Serial.println("Initializing frame processor...");
   
-  // Calculate memory requirements
+  // Calculate memory requirements; parity areas come later, with the first parity packets
   uint32_t frameBufferSize = Config::MAX_FRAME_SIZE;
-  uint32_t assemblyBufferSize = Config::MAX_FRAME_SIZE;
-  uint32_t packetTrackingSize = Config::MAX_PACKETS;
-  uint32_t totalNeeded = frameBufferSize + assemblyBufferSize + packetTrackingSize;
+  uint32_t totalNeeded = FRAME_BUFFER_COUNT * frameBufferSize;
+  
+  if (Config::MAX_PACKETS > PacketBitset::CAPACITY) {
+    Serial.printf("MAX_PACKETS %d exceeds packet bitset capacity %d\n", 
+                 Config::MAX_PACKETS, PacketBitset::CAPACITY);
+    return false;
+  }
   
   uint32_t availableHeap = ESP.getFreeHeap();
   Serial.printf("Memory check: Need %d KB, Available %d KB\n", 
@@ -74,154 +198,492 @@ bool FrameProcessor::initialize() {
   }
   
   // Allocate buffers
-  frameBuffer = (uint8_t*)heap_caps_malloc(frameBufferSize, MALLOC_CAP_8BIT);
-  assemblyBuffer = (uint8_t*)heap_caps_malloc(assemblyBufferSize, MALLOC_CAP_8BIT);
-  packetReceived = (bool*)heap_caps_malloc(packetTrackingSize, MALLOC_CAP_8BIT);
+  for (uint8_t i = 0; i < FRAME_BUFFER_COUNT; i++) {
+    FrameDescriptor& frame = frameBuffers[i];
+    frame.data = (uint8_t*)heap_caps_malloc(frameBufferSize, MALLOC_CAP_8BIT);
+    
+    if (!frame.data) {
+      Serial.printf("Failed to allocate frame buffer %d\n", i);
+      cleanup();
+      return false;
+    }
+    
+    memset(frame.data, 0, frameBufferSize);
+    frame.frameId = 0;
+    frame.totalPackets = 0;
+    frame.totalSize = 0;
+    frame.startTime = 0;
+    frame.firstPacketUs = 0;
+    frame.completeUs = 0;
+  }
   
-  if (!frameBuffer || !assemblyBuffer || !packetReceived) {
-    Serial.println("Failed to allocate frame processor buffers");
-    cleanup();
-    return false;
+  // Initial roles: one buffer per slot, then the (stale) ready and decoding buffers
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    FrameSlot& slot = slots[i];
+    slot.bufferIndex = i;
+    slot.buffer = frameBuffers[i].data;
+    slot.received.clear();
+    slot.parity = nullptr;
+    slot.parityReceived = 0;
+    slot.fecGroupSize = 0;
+    slot.state.reset();
+  }
+  
+  // Stream history starts over too: the benchmark re-initializes after its synthetic frames
+  for (uint8_t i = 0; i < REBUILT_HISTORY; i++) {
+    rebuiltPackets[i].packetIndex = NO_PACKET;
   }
+  rebuiltNext = 0;
+  lastReadyFrameId = 0;
+  retransmitRtt = Config::NACK_INITIAL_RTT;
   
-  // Initialize buffers
-  memset(frameBuffer, 0, frameBufferSize);
-  memset(assemblyBuffer, 0, assemblyBufferSize);
-  memset(packetReceived, false, packetTrackingSize);
+  readyBuffer.store(Config::REASSEMBLY_SLOTS, std::memory_order_release);
+  decodingBuffer = Config::REASSEMBLY_SLOTS + 1;
   
   // Create synchronization objects
-  frameMutex = xSemaphoreCreateMutex();
   displayMutex = xSemaphoreCreateMutex();
   
-  if (frameMutex == NULL || displayMutex == NULL) {
+  if (displayMutex == NULL) {
     Serial.println("Failed to create frame processor mutexes!");
     cleanup();
     return false;
   }
   
-  Serial.printf("Frame processor initialized: %d KB allocated\n", totalNeeded/1024);
+  Serial.printf("Frame processor initialized: %d KB allocated, %d reassembly slots, FEC %s\n", 
+               totalNeeded/1024, Config::REASSEMBLY_SLOTS, Config::FEC_ENABLED ? "on" : "off");
   return true;
 }
 
 void FrameProcessor::cleanup() {
-  if (frameBuffer) { heap_caps_free(frameBuffer); frameBuffer = nullptr; }
-  if (assemblyBuffer) { heap_caps_free(assemblyBuffer); assemblyBuffer = nullptr; }
-  if (packetReceived) { heap_caps_free(packetReceived); packetReceived = nullptr; }
-  if (frameMutex) { vSemaphoreDelete(frameMutex); frameMutex = nullptr; }
+  for (uint8_t i = 0; i < FRAME_BUFFER_COUNT; i++) {
+    if (frameBuffers[i].data) { heap_caps_free(frameBuffers[i].data); frameBuffers[i].data = nullptr; }
+  }
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    slots[i].buffer = nullptr;
+    if (slots[i].parity) { heap_caps_free(slots[i].parity); slots[i].parity = nullptr; }
+    slots[i].parityReceived = 0;
+    slots[i].state.reset();
+  }
   if (displayMutex) { vSemaphoreDelete(displayMutex); displayMutex = nullptr; }
 }
 
 bool FrameProcessor::processPacket(uint8_t* packetData, int size) {
-  if (!packetData || size < 12) return false;
+  if (!packetData) return false;
+  TraceScope trace(TraceRecorder::TRACE_PACKET);
   
-  // Fast packet header parsing
-  uint32_t frame_id = *(uint32_t*)&packetData[0];
-  uint16_t total_packets = *(uint16_t*)&packetData[4];
-  uint16_t packet_idx = *(uint16_t*)&packetData[6];
-  uint32_t packet_size = *(uint32_t*)&packetData[8];
-  uint8_t* payload = &packetData[12];
-  uint32_t actualDataSize = size - 12;
+  WireProto::PacketHeader header;
+  if (!WireProto::parseHeader(packetData, size, header, Config::ACCEPT_V1_PACKETS)) return false;
+  trace.setFrame(header.frameId);
   
-  // Quick validation
-  if (packet_size != actualDataSize || packet_idx >= total_packets || 
-      total_packets == 0 || total_packets > Config::MAX_PACKETS) {
+  PacketPlacement placement;
+  uint8_t* destination = reservePayload(header, placement);
+  if (!destination || (uint32_t)size != header.headerSize + placement.payloadSize) {
     return false;
   }
   
-  if (!lockFrame(5)) return false;
+  memcpy(destination, packetData + header.headerSize, placement.payloadSize);
+  return commitPayload(placement);
+}
+
+uint8_t* FrameProcessor::reservePayload(const WireProto::PacketHeader& header, PacketPlacement& placement) {
+  uint32_t frame_id = header.frameId;
+  uint16_t total_packets = header.totalPackets;
+  uint16_t packet_idx = header.packetIndex;
+  uint32_t packet_size = header.payloadLength;
   
-  bool success = false;
+  // Quick validation
+  if (total_packets == 0 || total_packets > Config::MAX_PACKETS) {
+    return nullptr;
+  }
   
-  // Handle first packet of new frame
-  if (packet_idx == 0) {
-    // Quick JPEG header validation
-    if (actualDataSize < 2 || payload[0] != 0xFF || payload[1] != 0xD8) {
-      unlockFrame();
-      return false;
+  // Parity packets follow the data packets: index total_packets + group
+  bool isParity = (header.flags & WireProto::FLAG_PARITY) != 0;
+  uint16_t parityGroup = packet_idx - total_packets;
+  uint32_t offset = 0;
+  PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+  
+  if (isParity) {
+    if (!Config::FEC_ENABLED || packet_idx < total_packets || 
+        parityGroup >= Config::FEC_MAX_GROUPS || packet_size != WireProto::PARITY_PAYLOAD_SIZE) {
+      return nullptr;
     }
     
-    // Fast frame initialization
-    currentFrame.frameId = frame_id;
-    currentFrame.totalPackets = total_packets;
-    currentFrame.receivedPackets = 1;
-    currentFrame.totalSize = packet_size;
-    currentFrame.startTime = millis();
-    currentFrame.isComplete = false;
-    currentFrame.isValid = false;
-    currentFrame.isRendering = false;
-    
-    PerformanceMonitor::getInstance().incrementFramesStarted();
+    offset = (uint32_t)parityGroup * packet_size;
+    pm.addParityBytes(packet_size);
+  } else {
+    // Payload position is fixed by the packet index, so arrival order is irrelevant.
+    // Every packet but the last carries exactly one full payload, and a v2
+    // sender's explicit offset and frame length have to agree with that.
+    offset = (uint32_t)packet_idx * Config::PACKET_PAYLOAD_SIZE;
+    bool isLastPacket = (packet_idx == total_packets - 1);
+    if (packet_idx >= total_packets || header.byteOffset != offset ||
+        packet_size > Config::PACKET_PAYLOAD_SIZE || 
+        (!isLastPacket && packet_size != Config::PACKET_PAYLOAD_SIZE) ||
+        (isLastPacket && header.frameLength != 0 && offset + packet_size != header.frameLength) ||
+        offset + packet_size > Config::MAX_FRAME_SIZE) {
+      return nullptr;
+    }
     
-    // Fast packet tracking reset
-    memset(packetReceived, false, Config::MAX_PACKETS);
-    packetReceived[0] = true;
+    pm.addDataBytes(packet_size);
+  }
+  
+  if (header.flags & WireProto::FLAG_RETRANSMIT) {
+    pm.incrementRetransmittedPackets();
+  }
+  
+  uint8_t* destination = nullptr;
+  FrameSlot* slot = findSlot(frame_id);
+  
+  // Any packet of an unseen frame opens a slot
+  if (!slot) {
+    slot = allocateSlot(frame_id);
     
-    // Fast buffer copy
-    if (packet_size <= Config::MAX_FRAME_SIZE) {
-      memcpy(assemblyBuffer, payload, packet_size);
-      success = true;
+    if (slot) {
+      CompleteFrameState& frame = slot->state;
+      frame.frameId = frame_id;
+      frame.totalPackets = total_packets;
+      frame.receivedPackets = 0;
+      frame.totalSize = 0;
+      frame.startTime = millis();
+      frame.firstPacketUs = micros();
+      frame.completeUs = 0;
+      frame.isComplete = false;
+      frame.isValid = false;
+      frame.isRendering = false;
       
-      // Single packet frame check
-      if (total_packets == 1) {
-        currentFrame.isComplete = true;
-      }
+      // Fast packet tracking reset
+      slot->received.clear();
+      slot->lastPacketTime = frame.startTime;
     }
+  }
+  
+  // Duplicates and packets that disagree with the frame layout are not read
+  if (slot && slot->state.totalPackets == total_packets) {
+    bool isDuplicate = isParity ? (slot->parityReceived & (1 << parityGroup)) != 0
+                                : slot->received.test(packet_idx);
     
-  } else {
-    // Fast continuation packet handling
-    if (frame_id == currentFrame.frameId && currentFrame.receivedPackets > 0) {
-      
-      // Quick duplicate check
-      if (!packetReceived[packet_idx]) {
-        
-        // Fast size validation
-        if (currentFrame.totalSize + packet_size <= Config::MAX_FRAME_SIZE) {
-          
-          // High-speed packet copy
-          memcpy(assemblyBuffer + currentFrame.totalSize, payload, packet_size);
-          currentFrame.totalSize += packet_size;
-          currentFrame.receivedPackets++;
-          packetReceived[packet_idx] = true;
-          success = true;
-          
-          // Frame completion check
-          if (currentFrame.receivedPackets == currentFrame.totalPackets) {
-            currentFrame.isComplete = true;
-          }
-        }
-      }
+    if (!isDuplicate && (!isParity || allocateParity(*slot))) {
+      placement.slot = slot;
+      placement.frameId = frame_id;
+      placement.packetIndex = packet_idx;
+      placement.payloadSize = packet_size;
+      placement.isParity = isParity;
+      destination = (isParity ? slot->parity : slot->buffer) + offset;
     }
   }
   
-  unlockFrame();
-  return success;
+  // The original of a packet parity already rebuilt: its frame may be gone by now
+  if (!destination && !isParity && wasRebuilt(frame_id, packet_idx)) {
+    pm.incrementEarlyRebuilds();
+  }
+  
+  return destination;
 }
 
-bool FrameProcessor::assembleCompleteFrame() {
-  if (!assemblyBuffer || !packetReceived) return false;
+bool FrameProcessor::commitPayload(const PacketPlacement& placement) {
+  FrameSlot* slot = placement.slot;
+  if (!slot) return false;
+  
+  if (placement.isParity) return commitParity(*slot, placement);
   
-  // Verify ALL packets received
-  for (uint16_t i = 0; i < currentFrame.totalPackets; i++) {
-    if (!packetReceived[i]) {
-      Serial.printf("Missing packet %d in frame %d\n", i, currentFrame.frameId);
+  // Quick JPEG header validation
+  if (placement.packetIndex == 0) {
+    const uint8_t* payload = slot->buffer;
+    if (placement.payloadSize < 2 || payload[0] != 0xFF || payload[1] != 0xD8) {
       return false;
     }
   }
   
+  bool success = false;
+  CompleteFrameState& frame = slot->state;
+  
+  if (frame.frameId == placement.frameId && !slot->received.test(placement.packetIndex)) {
+    if (slot->isFree()) {
+      PerformanceMonitor::getInstance().incrementFramesStarted();
+    }
+    
+    frame.totalSize += placement.payloadSize;
+    frame.receivedPackets++;
+    slot->received.set(placement.packetIndex);
+    success = true;
+    
+    // First packet after a retransmit request measures the repair round trip
+    slot->lastPacketTime = millis();
+    if (slot->nackTime != 0) {
+      uint32_t sample = slot->lastPacketTime - slot->nackTime;
+      retransmitRtt = (retransmitRtt * 7 + sample) / 8;
+      slot->nackTime = 0;
+    }
+    
+    // This packet may leave its group one short of a parity we already hold
+    if (slot->fecGroupSize > 0) {
+      recoverPacket(*slot, placement.packetIndex / slot->fecGroupSize);
+    }
+    
+    // Frame completion check
+    if (frame.receivedPackets == frame.totalPackets) {
+      publishSlot(*slot);
+    }
+  }
+  
+  return success;
+}
+
+bool FrameProcessor::allocateParity(FrameSlot& slot) {
+  if (slot.parity) return true;
+  
+  slot.parity = (uint8_t*)heap_caps_malloc(PARITY_AREA_SIZE, MALLOC_CAP_8BIT);
+  if (!slot.parity) {
+    PerformanceMonitor::getInstance().incrementMemoryErrors();
+    return false;
+  }
+  return true;
+}
+
+bool FrameProcessor::commitParity(FrameSlot& slot, const PacketPlacement& placement) {
+  CompleteFrameState& frame = slot.state;
+  uint16_t group = placement.packetIndex - frame.totalPackets;
+  const uint8_t* parity = slot.parity + (uint32_t)group * placement.payloadSize;
+  
+  // Every parity packet of a frame must agree on the group size
+  uint8_t groupSize = parity[0];
+  if (frame.frameId != placement.frameId || groupSize == 0 ||
+      (slot.fecGroupSize != 0 && groupSize != slot.fecGroupSize)) {
+    return false;
+  }
+  
+  if (slot.isFree()) {
+    PerformanceMonitor::getInstance().incrementFramesStarted();
+  }
+  
+  slot.fecGroupSize = groupSize;
+  slot.parityReceived |= (1 << group);
+  slot.lastPacketTime = millis();
+  
+  recoverPacket(slot, group);
+  
+  if (frame.receivedPackets == frame.totalPackets) {
+    publishSlot(slot);
+  }
+  
+  return true;
+}
+
+void FrameProcessor::recoverPacket(FrameSlot& slot, uint16_t group) {
+  CompleteFrameState& frame = slot.state;
+  if (group >= Config::FEC_MAX_GROUPS || !(slot.parityReceived & (1 << group))) return;
+  
+  uint16_t first = group * slot.fecGroupSize;
+  if (first >= frame.totalPackets) return;
+  uint16_t end = min<uint16_t>(first + slot.fecGroupSize, frame.totalPackets);
+  
+  // Parity rebuilds exactly one missing packet per group
+  int missing = slot.received.firstMissing(end, first);
+  if (missing < 0 || slot.received.firstMissing(end, missing + 1) >= 0) return;
+  
+  const uint32_t payloadSize = Config::PACKET_PAYLOAD_SIZE;
+  const uint8_t* parity = slot.parity + 
+    (uint32_t)group * WireProto::PARITY_PAYLOAD_SIZE;
+  uint16_t xorLength = WireProto::load16(parity + 2);
+  uint16_t lastIndex = frame.totalPackets - 1;
+  
+  // Only the final packet may be short; its size falls out of the XORed lengths
+  uint32_t length = payloadSize;
+  uint32_t lastSize = payloadSize;
+  if (missing == lastIndex) {
+    length = xorLength;
+    for (uint16_t i = first; i < end; i++) {
+      if (i != missing) length ^= payloadSize;
+    }
+  } else if (slot.received.test(lastIndex)) {
+    lastSize = frame.totalSize - (uint32_t)(frame.receivedPackets - 1) * payloadSize;
+  }
+  
+  uint32_t offset = (uint32_t)missing * payloadSize;
+  if (length == 0 || length > payloadSize || offset + length > Config::MAX_FRAME_SIZE) return;
+  
+  uint8_t* destination = slot.buffer + offset;
+  memcpy(destination, parity + WireProto::PARITY_HEADER_SIZE, length);
+  for (uint16_t i = first; i < end; i++) {
+    if (i == missing) continue;
+    uint32_t size = (i == lastIndex) ? lastSize : payloadSize;
+    WireProto::xorPayload(destination, slot.buffer + (uint32_t)i * payloadSize, min(length, size));
+  }
+  
+  frame.totalSize += length;
+  frame.receivedPackets++;
+  slot.received.set(missing);
+  PerformanceMonitor::getInstance().incrementRecoveredPackets();
+  
+  RebuiltPacket& rebuilt = rebuiltPackets[rebuiltNext];
+  rebuilt.frameId = frame.frameId;
+  rebuilt.packetIndex = missing;
+  rebuiltNext = (rebuiltNext + 1) % REBUILT_HISTORY;
+}
+
+bool FrameProcessor::wasRebuilt(uint32_t frameId, uint16_t packetIndex) {
+  for (uint8_t i = 0; i < REBUILT_HISTORY; i++) {
+    RebuiltPacket& rebuilt = rebuiltPackets[i];
+    if (rebuilt.packetIndex == packetIndex && rebuilt.frameId == frameId) {
+      rebuilt.packetIndex = NO_PACKET;   // Count each original once
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FrameProcessor::isStaleFrame(uint32_t frameId) const {
+  int32_t age = (int32_t)(lastReadyFrameId - frameId);
+  return lastReadyFrameId != 0 && age >= 0 && age < STALE_FRAME_WINDOW;
+}
+
+FrameSlot* FrameProcessor::findSlot(uint32_t frameId) {
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    if (!slots[i].isFree() && slots[i].state.frameId == frameId) {
+      return &slots[i];
+    }
+  }
+  return nullptr;
+}
+
+FrameSlot* FrameProcessor::allocateSlot(uint32_t frameId) {
+  // Late packet for a frame at or behind the one already displayed
+  if (isStaleFrame(frameId)) return nullptr;
+  
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    if (slots[i].isFree()) return &slots[i];
+  }
+  
+  FrameSlot* victim = selectEvictionVictim();
+  if (!victim) return nullptr;
+  
+  // Never give up a newer frame for an older one
+  if ((int32_t)(frameId - victim->state.frameId) < 0) return nullptr;
+  
+  PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+  pm.incrementEvictedFrames();
+  pm.addLostPackets(victim->state.totalPackets - victim->state.receivedPackets);
+  releaseSlot(*victim);
+  return victim;
+}
+
+FrameSlot* FrameProcessor::selectEvictionVictim() {
+  FrameSlot* victim = nullptr;
+  
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    FrameSlot& candidate = slots[i];
+    if (candidate.isFree()) continue;
+    
+    if (!victim) {
+      victim = &candidate;
+      continue;
+    }
+    
+    bool older = (int32_t)(candidate.state.frameId - victim->state.frameId) < 0;
+    if (Config::SLOT_EVICTION_POLICY == Config::EVICT_LEAST_COMPLETE) {
+      if (candidate.state.receivedPackets < victim->state.receivedPackets ||
+          (candidate.state.receivedPackets == victim->state.receivedPackets && older)) {
+        victim = &candidate;
+      }
+    } else if (older) {
+      victim = &candidate;
+    }
+  }
+  
+  return victim;
+}
+
+void FrameProcessor::publishSlot(FrameSlot& slot) {
+  uint32_t completeUs = micros();
+  PerformanceMonitor::getInstance().recordLatency(PerformanceMonitor::LATENCY_ASSEMBLY, 
+                                                  completeUs - slot.state.firstPacketUs);
+  
+  // An older frame finishing after a newer one was published is never shown
+  if (isStaleFrame(slot.state.frameId)) {
+    PerformanceMonitor::getInstance().incrementSkippedFrames();
+    releaseSlot(slot);
+    return;
+  }
+  
+  FrameDescriptor& frame = frameBuffers[slot.bufferIndex];
+  frame.frameId = slot.state.frameId;
+  frame.totalPackets = slot.state.totalPackets;
+  frame.totalSize = slot.state.totalSize;
+  frame.startTime = slot.state.startTime;
+  frame.firstPacketUs = slot.state.firstPacketUs;
+  frame.completeUs = completeUs;
+  
+  // Swap the finished buffer into the mailbox; the slot carries on with the
+  // buffer that was there. If that one was still fresh the display skipped it.
+  uint8_t previous = readyBuffer.exchange(slot.bufferIndex | FRESH_FRAME, 
+                                          std::memory_order_acq_rel);
+  slot.bufferIndex = previous & ~FRESH_FRAME;
+  slot.buffer = frameBuffers[slot.bufferIndex].data;
+  if (previous & FRESH_FRAME) {
+    PerformanceMonitor::getInstance().incrementSkippedFrames();
+  }
+  
+  if (slot.nackAttempts > 0) {
+    PerformanceMonitor::getInstance().incrementRepairedFrames();
+  }
+  
+  lastReadyFrameId = frame.frameId;
+  releaseSlot(slot);
+}
+
+void FrameProcessor::releaseSlot(FrameSlot& slot) {
+  slot.state.reset();
+  slot.parityReceived = 0;
+  slot.fecGroupSize = 0;
+  slot.nackTime = 0;
+  slot.nackAttempts = 0;
+}
+
+FrameDescriptor* FrameProcessor::acquireFrame() {
+  if (!isFrameComplete()) return nullptr;
+  
+  // Hand the previous decoding buffer back and take the newest ready frame
+  uint8_t ready = readyBuffer.exchange(decodingBuffer, std::memory_order_acq_rel);
+  decodingBuffer = ready & ~FRESH_FRAME;
+  return &frameBuffers[decodingBuffer];
+}
+
+uint8_t FrameProcessor::getActiveSlots() const {
+  uint8_t active = 0;
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    if (!slots[i].isFree()) active++;
+  }
+  return active;
+}
+
+bool FrameProcessor::assembleCompleteFrame() {
+  // Take the newest complete frame; it stays in its buffer until the next one
+  FrameDescriptor* frame = acquireFrame();
+  if (!frame) return false;
+  TraceScope trace(TraceRecorder::TRACE_ASSEMBLE, frame->frameId);
+  
+  currentFrame.frameId = frame->frameId;
+  currentFrame.totalPackets = frame->totalPackets;
+  currentFrame.receivedPackets = frame->totalPackets;
+  currentFrame.totalSize = frame->totalSize;
+  currentFrame.startTime = frame->startTime;
+  currentFrame.firstPacketUs = frame->firstPacketUs;
+  currentFrame.completeUs = frame->completeUs;
+  currentFrame.isComplete = true;
+  currentFrame.isValid = false;
+  
   // Validate complete JPEG
-  if (!validateCompleteJPEG(assemblyBuffer, currentFrame.totalSize)) {
-    Serial.printf("Invalid JPEG in frame %d\n", currentFrame.frameId);
+  if (!validateCompleteJPEG(frame->data, frame->totalSize)) {
+    AsyncLogger::getInstance().log("Invalid JPEG in frame %d\n", currentFrame.frameId);
     PerformanceMonitor::getInstance().incrementCorruptFrames();
     return false;
   }
   
-  // Copy to final frame buffer
-  memcpy(frameBuffer, assemblyBuffer, currentFrame.totalSize);
   currentFrame.isValid = true;
   PerformanceMonitor::getInstance().incrementCompleteFrames();
   
-  Serial.printf("Frame %d assembled: %d packets, %d bytes\n", 
-               currentFrame.frameId, currentFrame.totalPackets, currentFrame.totalSize);
+  AsyncLogger::getInstance().log("Frame %d assembled: %d packets, %d bytes\n", 
+                                 currentFrame.frameId, currentFrame.totalPackets, currentFrame.totalSize);
   
   return true;
 }
@@ -246,16 +708,69 @@ bool FrameProcessor::validateCompleteJPEG(uint8_t* buffer, uint32_t size) {
 }
 
 void FrameProcessor::handleFrameTimeout() {
-  if (currentFrame.receivedPackets > 0 && 
-      (millis() - currentFrame.startTime) > Config::FRAME_TIMEOUT) {
+  PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    FrameSlot& slot = slots[i];
+    if (!slot.isFree() && (now - slot.state.startTime) > Config::FRAME_TIMEOUT) {
+      pm.incrementIncompleteFrames();
+      pm.addLostPackets(slot.state.totalPackets - slot.received.count(slot.state.totalPackets));
+      releaseSlot(slot);
+    }
+  }
+}
+
+int FrameProcessor::buildRetransmitRequest(uint8_t* request, int maxSize) {
+  if (!Config::NACK_ENABLED || !request || maxSize <= WireProto::NACK_HEADER_SIZE) return 0;
+  
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < Config::REASSEMBLY_SLOTS; i++) {
+    FrameSlot& slot = slots[i];
+    CompleteFrameState& frame = slot.state;
+    if (slot.isFree() || slot.nackAttempts >= Config::NACK_MAX_ATTEMPTS) continue;
+    
+    // Packets still flowing, or the previous request not yet answered
+    if (now - slot.lastPacketTime < Config::NACK_STALL_TIME) continue;
+    if (slot.nackTime != 0 && now - slot.nackTime < 2 * retransmitRtt) continue;
     
-    if (lockFrame(2)) {
-      currentFrame.receivedPackets = 0;
-      currentFrame.isComplete = false;
-      PerformanceMonitor::getInstance().incrementIncompleteFrames();
-      unlockFrame();
+    // Only frames a few packets short, whose repair can land before the timeout
+    // and that a newer displayed frame has not already overtaken
+    uint16_t missingCount = frame.totalPackets - frame.receivedPackets;
+    if (missingCount == 0 || missingCount > Config::NACK_MAX_MISSING) continue;
+    if ((now - frame.startTime) + retransmitRtt >= Config::FRAME_TIMEOUT) continue;
+    if (isStaleFrame(frame.frameId)) continue;
+    
+    // Bitmap of missing packets, bit 0 = packet 'base'
+    int first = slot.received.firstMissing(frame.totalPackets);
+    uint16_t base = first & ~7;
+    uint16_t bitmapBytes = 0;
+    memset(request + WireProto::NACK_HEADER_SIZE, 0, maxSize - WireProto::NACK_HEADER_SIZE);
+    
+    for (int index = first; index >= 0; 
+         index = slot.received.firstMissing(frame.totalPackets, index + 1)) {
+      uint16_t bit = index - base;
+      if (WireProto::NACK_HEADER_SIZE + bit / 8 >= maxSize) break;
+      request[WireProto::NACK_HEADER_SIZE + bit / 8] |= 1 << (bit & 7);
+      bitmapBytes = bit / 8 + 1;
     }
+    
+    WireProto::store32(request, WireProto::NACK_MAGIC);
+    WireProto::store32(request + 4, frame.frameId);
+    WireProto::store16(request + 8, frame.totalPackets);
+    WireProto::store16(request + 10, base);
+    WireProto::store16(request + 12, bitmapBytes);
+    
+    slot.nackTime = now;
+    slot.nackAttempts++;
+    
+    PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+    pm.incrementRetransmitRequests();
+    pm.addRequestedPackets(missingCount);
+    
+    return WireProto::NACK_HEADER_SIZE + bitmapBytes;
   }
+  
+  return 0;
 }
 
 void FrameProcessor::resetCurrentFrame() {
@@ -264,15 +779,8 @@ void FrameProcessor::resetCurrentFrame() {
   currentFrame.receivedPackets = 0;
 }
 
-bool FrameProcessor::lockFrame(uint32_t timeoutMs) {
-  return xSemaphoreTake(frameMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
-}
-
-void FrameProcessor::unlockFrame() {
-  xSemaphoreGive(frameMutex);
-}
-
 bool FrameProcessor::lockDisplay(uint32_t timeoutMs) {
+  TraceScope trace(TraceRecorder::TRACE_DISPLAY_LOCK_WAIT);
   return xSemaphoreTake(displayMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
 }
 
@@ -0,0 +1,221 @@
+// frame_scaler.h
+#ifndef FRAME_SCALER_H
+#define FRAME_SCALER_H
+
+#include "config.h"
+
+// Resamples RGB565 lines from the decoder's strip to a larger output size,
+// nearest or 2-tap bilinear in each direction. Positions are 16.16 fixed
+// point; the source column and weight of every output column are computed
+// once per geometry, and output rows are worked out as they go. Source rows
+// arrive a strip at a time: the scaler keeps the last row of the previous
+// strip so output rows that straddle two strips can still be blended.
+class FrameScaler {
+private:
+  uint16_t* columnIndex;    // Left source column of each output column
+  uint8_t* columnWeight;    // Weight of the right one, 0..32
+  uint16_t* carryLine;      // Last row of the previous source strip
+  int32_t carryRow;
+  
+  Config::ScaleMode mode;
+  uint16_t sourceWidth;
+  uint16_t sourceHeight;
+  uint16_t outputWidth;
+  uint16_t outputHeight;
+  uint32_t stepY;           // Source rows per output row, 16.16
+  uint16_t nextRow;         // Next output row to produce this frame
+  
+  void sourceRowFor(uint16_t outputRow, uint16_t& row, uint8_t& weight) const;
+  
+public:
+  FrameScaler() : columnIndex(nullptr), columnWeight(nullptr), carryLine(nullptr), carryRow(-1),
+                  mode(Config::SCALE_OFF), sourceWidth(0), sourceHeight(0), outputWidth(0),
+                  outputHeight(0), stepY(0), nextRow(0) {}
+  ~FrameScaler() { cleanup(); }
+  
+  // Tables for outputs up to DISPLAY_WIDTH wide, about 2.4 KB
+  bool initialize();
+  void cleanup();
+  bool isReady() const { return columnIndex != nullptr; }
+  
+  // Rebuilds the column tables when the geometry changes; the source must be
+  // at least 2x2 and smaller than the output
+  bool configure(Config::ScaleMode scaleMode, uint16_t srcWidth, uint16_t srcHeight,
+                 uint16_t outWidth, uint16_t outHeight);
+  void beginFrame() { nextRow = 0; carryRow = -1; }
+  
+  // Writes the output rows that source rows [firstRow, firstRow + rows) complete
+  // into output, outputWidth apart, at most maxRows of them. Call again while
+  // it fills maxRows; once it returns fewer, the strip is consumed.
+  uint16_t scaleRows(const uint16_t* source, uint16_t firstRow, uint16_t rows,
+                     uint16_t* output, uint16_t maxRows);
+  
+  uint16_t getOutputWidth() const { return outputWidth; }
+  uint16_t getOutputHeight() const { return outputHeight; }
+  uint16_t getRowsDone() const { return nextRow; }
+  
+  // Largest size the source fits in, keeping its aspect ratio or not
+  static void fitSize(uint16_t srcWidth, uint16_t srcHeight, uint16_t maxWidth, uint16_t maxHeight,
+                      bool keepAspect, uint16_t& outWidth, uint16_t& outHeight);
+};
+
+#endif // FRAME_SCALER_H
+
+// frame_scaler.cpp
+#include "frame_scaler.h"
+
+// RGB565 spread over 32 bits as 00000GGGGGG00000RRRRR000000BBBBB: each field has
+// five spare bits above it, room for a weight of up to 32
+static const uint32_t SPREAD_MASK = 0x07E0F81F;
+
+static inline uint32_t spread(uint16_t color) {
+  return (color | ((uint32_t)color << 16)) & SPREAD_MASK;
+}
+
+static inline uint32_t blend(uint32_t a, uint32_t b, uint8_t weight) {
+  return ((a * (32 - weight) + b * weight) >> 5) & SPREAD_MASK;
+}
+
+static inline uint16_t pack(uint32_t color) {
+  return (uint16_t)(color | (color >> 16));
+}
+
+bool FrameScaler::initialize() {
+  columnIndex = (uint16_t*)heap_caps_malloc(Config::DISPLAY_WIDTH * 2, MALLOC_CAP_8BIT);
+  columnWeight = (uint8_t*)heap_caps_malloc(Config::DISPLAY_WIDTH, MALLOC_CAP_8BIT);
+  carryLine = (uint16_t*)heap_caps_malloc(Config::DISPLAY_WIDTH * 2, MALLOC_CAP_8BIT);
+  if (!columnIndex || !columnWeight || !carryLine) {
+    cleanup();
+    return false;
+  }
+  outputWidth = outputHeight = 0;
+  return true;
+}
+
+void FrameScaler::cleanup() {
+  if (columnIndex) heap_caps_free(columnIndex);
+  if (columnWeight) heap_caps_free(columnWeight);
+  if (carryLine) heap_caps_free(carryLine);
+  columnIndex = nullptr;
+  columnWeight = nullptr;
+  carryLine = nullptr;
+}
+
+void FrameScaler::fitSize(uint16_t srcWidth, uint16_t srcHeight, uint16_t maxWidth, uint16_t maxHeight,
+                          bool keepAspect, uint16_t& outWidth, uint16_t& outHeight) {
+  outWidth = maxWidth;
+  outHeight = maxHeight;
+  if (!keepAspect || !srcWidth || !srcHeight) return;
+  
+  // 320x240 on 480x320: the height limits, 426x320
+  if ((uint32_t)srcWidth * maxHeight <= (uint32_t)maxWidth * srcHeight) {
+    outWidth = (uint32_t)srcWidth * maxHeight / srcHeight;
+  } else {
+    outHeight = (uint32_t)srcHeight * maxWidth / srcWidth;
+  }
+}
+
+bool FrameScaler::configure(Config::ScaleMode scaleMode, uint16_t srcWidth, uint16_t srcHeight,
+                            uint16_t outWidth, uint16_t outHeight) {
+  if (!isReady() || scaleMode == Config::SCALE_OFF || srcWidth < 2 || srcHeight < 2 ||
+      outWidth < srcWidth || outHeight < srcHeight || outWidth > Config::DISPLAY_WIDTH ||
+      (outWidth == srcWidth && outHeight == srcHeight)) {
+    return false;
+  }
+  if (scaleMode == mode && srcWidth == sourceWidth && srcHeight == sourceHeight &&
+      outWidth == outputWidth && outHeight == outputHeight) {
+    return true;
+  }
+  
+  mode = scaleMode;
+  sourceWidth = srcWidth;
+  sourceHeight = srcHeight;
+  outputWidth = outWidth;
+  outputHeight = outHeight;
+  stepY = ((uint32_t)srcHeight << 16) / outHeight;
+  
+  // Output pixel centres mapped onto the source grid. Nearest takes the pixel
+  // under the centre; bilinear blends the two around it, clamped at the edges.
+  uint32_t stepX = ((uint32_t)srcWidth << 16) / outWidth;
+  for (uint16_t x = 0; x < outWidth; x++) {
+    uint32_t centre = x * stepX + (stepX >> 1);
+    if (mode == Config::SCALE_NEAREST) {
+      columnIndex[x] = centre >> 16;
+      columnWeight[x] = 0;
+      continue;
+    }
+    
+    uint32_t position = centre > 0x8000 ? centre - 0x8000 : 0;
+    uint16_t index = position >> 16;
+    uint8_t weight = (position & 0xFFFF) >> 11;
+    if (index >= srcWidth - 1) {
+      index = srcWidth - 2;
+      weight = 32;
+    }
+    columnIndex[x] = index;
+    columnWeight[x] = weight;
+  }
+  return true;
+}
+
+void FrameScaler::sourceRowFor(uint16_t outputRow, uint16_t& row, uint8_t& weight) const {
+  uint32_t centre = outputRow * stepY + (stepY >> 1);
+  if (mode == Config::SCALE_NEAREST) {
+    row = centre >> 16;
+    weight = 0;
+    return;
+  }
+  
+  uint32_t position = centre > 0x8000 ? centre - 0x8000 : 0;
+  row = position >> 16;
+  weight = (position & 0xFFFF) >> 11;
+  if (row >= sourceHeight - 1) {
+    row = sourceHeight - 2;
+    weight = 32;
+  }
+}
+
+uint16_t FrameScaler::scaleRows(const uint16_t* source, uint16_t firstRow, uint16_t rows,
+                                uint16_t* output, uint16_t maxRows) {
+  uint16_t produced = 0;
+  
+  while (produced < maxRows && nextRow < outputHeight) {
+    uint16_t row;
+    uint8_t weight;
+    sourceRowFor(nextRow, row, weight);
+    uint16_t lastNeeded = weight ? row + 1 : row;
+    if (lastNeeded >= firstRow + rows) break;   // Wait for the next strip
+    
+    // Upscaling never steps back more than the carried row
+    const uint16_t* top = row < firstRow ? carryLine : source + (row - firstRow) * sourceWidth;
+    const uint16_t* bottom = row + 1 < firstRow ? carryLine : source + (row + 1 - firstRow) * sourceWidth;
+    uint16_t* out = output + produced * outputWidth;
+    
+    if (mode == Config::SCALE_NEAREST) {
+      for (uint16_t x = 0; x < outputWidth; x++) out[x] = top[columnIndex[x]];
+    } else if (weight == 0) {
+      for (uint16_t x = 0; x < outputWidth; x++) {
+        uint16_t i = columnIndex[x];
+        out[x] = pack(blend(spread(top[i]), spread(top[i + 1]), columnWeight[x]));
+      }
+    } else {
+      for (uint16_t x = 0; x < outputWidth; x++) {
+        uint16_t i = columnIndex[x];
+        uint8_t w = columnWeight[x];
+        uint32_t upper = blend(spread(top[i]), spread(top[i + 1]), w);
+        uint32_t lower = blend(spread(bottom[i]), spread(bottom[i + 1]), w);
+        out[x] = pack(blend(upper, lower, weight));
+      }
+    }
+    
+    produced++;
+    nextRow++;
+  }
+  
+  // Strip consumed: keep its last row for the output rows that straddle into the next
+  if (produced < maxRows && rows && carryRow != firstRow + rows - 1) {
+    memcpy(carryLine, source + (rows - 1) * sourceWidth, sourceWidth * 2);
+    carryRow = firstRow + rows - 1;
+  }
+  return produced;
+}
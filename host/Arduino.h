@@ -0,0 +1,86 @@
+// Arduino.h (host shim)
+// Minimal Arduino core surface for building the display firmware as a Linux process.
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "esp_heap_caps.h"
+
+using std::min;
+using std::max;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// Host only: in-process runners drive millis()/micros() from a virtual clock
+void hostUseVirtualTime(uint64_t startUs);
+void hostAdvanceTime(uint32_t us);
+
+class String : public std::string {
+public:
+  String() {}
+  String(const char* s) : std::string(s ? s : "") {}
+  String(const std::string& s) : std::string(s) {}
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+  size_t print(const char* str) { return write(str); }
+  size_t print(const String& str) { return write(str.c_str()); }
+  size_t print(int value) { return printf("%d", value); }
+  size_t print(unsigned int value) { return printf("%u", value); }
+  size_t println() { return write("\n"); }
+  size_t println(const char* str) { return print(str) + println(); }
+  size_t println(const String& str) { return print(str) + println(); }
+  size_t println(int value) { return print(value) + println(); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+  HardwareSerial() : muted(false) {}
+  void begin(unsigned long baud) { (void)baud; }
+  void setMuted(bool mute) { muted = mute; }  // Host only
+  int available();
+  int read();
+  void flush() { fflush(stdout); }
+  using Print::write;
+  size_t write(uint8_t c) override { return muted || fputc(c, stdout) != EOF ? 1 : 0; }
+  size_t write(const uint8_t* buffer, size_t size) override { return muted ? size : fwrite(buffer, 1, size, stdout); }
+
+private:
+  bool muted;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getPsramSize() { return 0; }
+  uint32_t getCycleCount();
+  const char* getChipModel() { return "host"; }
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
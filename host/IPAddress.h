@@ -0,0 +1,28 @@
+// IPAddress.h (host shim)
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  IPAddress() : addr{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr{a, b, c, d} {}
+  explicit IPAddress(uint32_t networkOrder) { memcpy(addr, &networkOrder, 4); }
+  
+  operator uint32_t() const { uint32_t v; memcpy(&v, addr, 4); return v; }
+  uint8_t operator[](int i) const { return addr[i]; }
+  bool operator==(const IPAddress& o) const { return memcmp(addr, o.addr, 4) == 0; }
+  bool operator!=(const IPAddress& o) const { return !(*this == o); }
+  
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+    return String(buf);
+  }
+
+private:
+  uint8_t addr[4];
+};
+
+#endif // HOST_IPADDRESS_H
@@ -0,0 +1,92 @@
+// TFT_eSPI.h (host shim)
+// Null display: accepts every drawing call and counts what would have gone over
+// SPI, so render-path changes can be measured without a panel attached.
+#ifndef HOST_TFT_ESPI_H
+#define HOST_TFT_ESPI_H
+
+#include "Arduino.h"
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_CYAN  0x07FF
+#define TFT_RED   0xF800
+
+class TFT_eSPI : public Print {
+public:
+  TFT_eSPI(int16_t w = 320, int16_t h = 480)
+    : rotation(0), nativeWidth(w), nativeHeight(h), swapBytes(false), dmaEnabled(false),
+      spiMhz(0), dmaDoneUs(0), pixelsPushed(0), addrWindows(0) {}
+  
+  void init() {}
+  void setRotation(uint8_t r) { rotation = r & 3; }
+  int16_t width() const { return (rotation & 1) ? nativeHeight : nativeWidth; }
+  int16_t height() const { return (rotation & 1) ? nativeWidth : nativeHeight; }
+  void setSwapBytes(bool swap) { swapBytes = swap; }
+  bool getSwapBytes() const { return swapBytes; }
+  
+  void fillScreen(uint32_t color) { fillRect(0, 0, width(), height(), color); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    (void)x; (void)y; (void)color;
+    addrWindows++;
+    pixelsPushed += (uint64_t)w * h;
+  }
+  void setTextColor(uint16_t fg, uint16_t bg) { (void)fg; (void)bg; }
+  void setTextSize(uint8_t s) { (void)s; }
+  void setCursor(int16_t x, int16_t y) { (void)x; (void)y; }
+  using Print::write;
+  size_t write(uint8_t c) override { (void)c; return 1; }
+  
+  void startWrite() {}
+  void endWrite() {}
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+    (void)x; (void)y; (void)w; (void)h;
+    addrWindows++;
+  }
+  void pushPixels(const void* data, uint32_t len) { (void)data; pixelsPushed += len; }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) {
+    setAddrWindow(x, y, w, h);
+    pushPixels(data, (uint32_t)(w * h));
+  }
+  
+  // DMA API: transfers complete immediately on the host, unless HOST_SPI_MHZ
+  // is set; then each one keeps the channel busy for as long as 16 bits per
+  // pixel take at that clock, so decode/transfer overlap can be measured.
+  bool initDMA(bool ctrl_cs = false) {
+    (void)ctrl_cs;
+    const char* mhz = getenv("HOST_SPI_MHZ");
+    spiMhz = mhz ? atoi(mhz) : 0;
+    dmaEnabled = true;
+    return true;
+  }
+  void deInitDMA() { dmaEnabled = false; }
+  bool dmaBusy() { return (int32_t)(dmaDoneUs - micros()) > 0; }
+  void dmaWait() { while (dmaBusy()) {} }
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* buffer = nullptr) {
+    (void)buffer;
+    dmaWait();
+    pushImage(x, y, w, h, data);
+    if (spiMhz > 0) dmaDoneUs = micros() + (uint32_t)(w * h) * 16 / spiMhz;
+  }
+  void pushPixelsDMA(uint16_t* data, uint32_t len) {
+    dmaWait();
+    pushPixels(data, len);
+    if (spiMhz > 0) dmaDoneUs = micros() + len * 16 / spiMhz;
+  }
+  
+  // Host-only instrumentation
+  uint64_t getPixelsPushed() const { return pixelsPushed; }
+  uint64_t getAddrWindows() const { return addrWindows; }
+
+private:
+  uint8_t rotation;
+  int16_t nativeWidth;
+  int16_t nativeHeight;
+  bool swapBytes;
+  bool dmaEnabled;
+  int spiMhz;
+  uint32_t dmaDoneUs;
+  uint64_t pixelsPushed;
+  uint64_t addrWindows;
+};
+
+#endif // HOST_TFT_ESPI_H
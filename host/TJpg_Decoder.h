@@ -0,0 +1,36 @@
+// TJpg_Decoder.h (host shim)
+// Stand-in for Bodmer's TJpg_Decoder. It reads the frame size from the JPEG SOF
+// marker and then delivers MCU blocks to the output callback in the same
+// raster order as the real decoder. The pixels are synthetic (derived from
+// the compressed bytes), so the render path sees realistic call patterns and
+// data-dependent content without a real entropy decoder.
+#ifndef HOST_TJPG_DECODER_H
+#define HOST_TJPG_DECODER_H
+
+#include "Arduino.h"
+
+typedef bool (*SketchCallback)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* data);
+
+enum JRESULT { JDR_OK = 0, JDR_INTR, JDR_INP, JDR_MEM1, JDR_MEM2, JDR_PAR, JDR_FMT1, JDR_FMT2, JDR_FMT3 };
+
+class TJpg_Decoder {
+public:
+  TJpg_Decoder() : scale(1), callback(nullptr), swap(false) {}
+  
+  void setJpgScale(uint8_t s) { scale = s ? s : 1; }
+  void setCallback(SketchCallback cb) { callback = cb; }
+  void setSwapBytes(bool s) { swap = s; }
+  
+  JRESULT getJpgSize(uint16_t* w, uint16_t* h, const uint8_t* data, uint32_t size);
+  JRESULT drawJpg(int32_t x, int32_t y, const uint8_t* data, uint32_t size);
+
+private:
+  uint8_t scale;
+  SketchCallback callback;
+  bool swap;
+  uint16_t mcuBuffer[16 * 16];
+};
+
+extern TJpg_Decoder TJpgDec;
+
+#endif // HOST_TJPG_DECODER_H
@@ -0,0 +1,45 @@
+// WiFi.h (host shim)
+// The host process is "the access point": softAP calls succeed and the UDP
+// socket binds on all local interfaces.
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_AP_START,
+  ARDUINO_EVENT_WIFI_AP_STOP,
+  ARDUINO_EVENT_WIFI_AP_STACONNECTED,
+  ARDUINO_EVENT_WIFI_AP_STADISCONNECTED,
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+typedef void (*WiFiEventCb)(WiFiEvent_t event);
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_DISCONNECTED = 6 } wl_status_t;
+
+class WiFiClass {
+public:
+  void onEvent(WiFiEventCb cb) { (void)cb; }
+  bool mode(wifi_mode_t m) { (void)m; return true; }
+  bool softAPConfig(IPAddress local, IPAddress gateway, IPAddress subnet) {
+    apIP = local; (void)gateway; (void)subnet; return true;
+  }
+  bool softAP(const char* ssid, const char* password = nullptr, int channel = 1,
+              int hidden = 0, int maxConnections = 4) {
+    (void)ssid; (void)password; (void)channel; (void)hidden; (void)maxConnections;
+    return true;
+  }
+  IPAddress softAPIP() const { return apIP; }
+  wl_status_t status() const { return WL_CONNECTED; }
+  int RSSI() const { return 0; }
+
+private:
+  IPAddress apIP;
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
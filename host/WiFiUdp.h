@@ -0,0 +1,51 @@
+// WiFiUdp.h (host shim)
+// WiFiUDP on top of a non-blocking POSIX datagram socket, with the same
+// parsePacket()/read() buffering semantics as the ESP32 Arduino core.
+#ifndef HOST_WIFIUDP_H
+#define HOST_WIFIUDP_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class WiFiUDP : public Print {
+public:
+  WiFiUDP() : fd(-1), rxLen(0), rxPos(0), txLen(0), txPort(0), rxPort(0) {}
+  ~WiFiUDP() { stop(); }
+  
+  uint8_t begin(uint16_t port);
+  void stop();
+  int fileDescriptor() const { return fd; }
+  
+  // Receive
+  int parsePacket();
+  int available() const { return (int)(rxLen - rxPos); }
+  int read();
+  int read(uint8_t* buffer, size_t len);
+  int read(char* buffer, size_t len) { return read((uint8_t*)buffer, len); }
+  int peek() const { return rxPos < rxLen ? rxBuf[rxPos] : -1; }
+  void flush() { rxPos = rxLen; }
+  IPAddress remoteIP() const { return rxAddr; }
+  uint16_t remotePort() const { return rxPort; }
+  
+  // Transmit
+  int beginPacket(IPAddress ip, uint16_t port);
+  int beginPacket(const char* host, uint16_t port);
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int endPacket();
+
+private:
+  int fd;
+  uint8_t rxBuf[1500];
+  size_t rxLen;
+  size_t rxPos;
+  uint8_t txBuf[1500];
+  size_t txLen;
+  IPAddress txAddr;
+  uint16_t txPort;
+  IPAddress rxAddr;
+  uint16_t rxPort;
+};
+
+#endif // HOST_WIFIUDP_H
@@ -0,0 +1,71 @@
+#!/bin/bash
+# Host build: runs the display firmware as a Linux process on top of the shims
+# in this directory. The firmware modules are kept as combined header +
+# implementation files, so they are split into src/*.h and src/*.cpp first,
+# the same layout the PlatformIO project uses.
+#
+#   host/build.sh              -> host/build/firmware, host/build/<runner>, host/build/<tool>
+#   CXXFLAGS="-O0 -g" host/build.sh
+set -e
+
+HOST_DIR="$(cd "$(dirname "$0")" && pwd)"
+REPO_DIR="$(dirname "$HOST_DIR")"
+BUILD_DIR="${BUILD_DIR:-$HOST_DIR/build}"
+SRC_DIR="$BUILD_DIR/src"
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--O2 -g}"
+
+rm -rf "$SRC_DIR"
+mkdir -p "$SRC_DIR"
+
+cd "$REPO_DIR"
+for f in *.h; do
+  case "$f" in
+    "main application file.h") cp "$f" "$SRC_DIR/main.cpp"; continue ;;
+    camera_pins.h) continue ;;
+  esac
+  
+  base="${f%.h}"
+  line=$(grep -n "^// $base.cpp" "$f" | head -1 | cut -d: -f1)
+  if [ -n "$line" ]; then
+    head -n $((line - 1)) "$f" > "$SRC_DIR/$base.h"
+    tail -n +"$line" "$f" > "$SRC_DIR/$base.cpp"
+  else
+    cp "$f" "$SRC_DIR/$base.h"
+  fi
+done
+cp config.cpp "$SRC_DIR/"
+
+FLAGS="-std=gnu++17 $CXXFLAGS -Wall -Wno-unused-parameter -pthread -DHOST_BUILD -I $SRC_DIR -I $HOST_DIR"
+
+# Firmware modules and the shim runtime as objects, shared by the firmware
+# and the in-process runners
+OBJ_DIR="$BUILD_DIR/obj"
+rm -rf "$OBJ_DIR"
+mkdir -p "$OBJ_DIR"
+pids=""
+for src in "$SRC_DIR"/*.cpp "$HOST_DIR/host_runtime.cpp"; do
+  [ "$(basename "$src")" = main.cpp ] && continue
+  $CXX $FLAGS -c "$src" -o "$OBJ_DIR/$(basename "$src" .cpp).o" &
+  pids="$pids $!"
+done
+for pid in $pids; do wait "$pid"; done
+
+$CXX $FLAGS "$SRC_DIR/main.cpp" "$HOST_DIR/host_main.cpp" "$OBJ_DIR"/*.o -o "$BUILD_DIR/firmware"
+echo "Built $BUILD_DIR/firmware"
+
+# In-process runners: own main(), firmware modules driven directly (no tasks)
+for runner in "$HOST_DIR"/runners/*.cpp; do
+  [ -e "$runner" ] || continue
+  name="$(basename "$runner" .cpp)"
+  $CXX $FLAGS -I "$REPO_DIR/tools" "$runner" "$OBJ_DIR"/*.o -o "$BUILD_DIR/$name"
+  echo "Built $BUILD_DIR/$name"
+done
+
+# Host-side tools (stream sender, ...)
+for tool in "$REPO_DIR"/tools/*.cpp; do
+  [ -e "$tool" ] || continue
+  name="$(basename "$tool" .cpp)"
+  $CXX -std=gnu++17 $CXXFLAGS -Wall -pthread "$tool" -o "$BUILD_DIR/$name"
+  echo "Built $BUILD_DIR/$name"
+done
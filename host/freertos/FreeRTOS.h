@@ -0,0 +1,33 @@
+// freertos/FreeRTOS.h (host shim)
+// Just enough of the ESP-IDF FreeRTOS API to run the firmware tasks as
+// std::threads. Ticks are 1 ms, matching the ESP32 Arduino configuration.
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+// Run-time counters are each task thread's CPU time in microseconds; the idle
+// tasks get whatever wall time the tasks pinned to their core did not use
+#define configUSE_TRACE_FACILITY 1
+#define configGENERATE_RUN_TIME_STATS 1
+
+// Core the calling task was pinned to (0 for threads not created as tasks).
+BaseType_t xPortGetCoreID();
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,43 @@
+// freertos/task.h (host shim)
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority,
+                                   TaskHandle_t* createdTask, BaseType_t coreId);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+// Run-time statistics (the fields the firmware reads)
+typedef struct {
+  TaskHandle_t xHandle;
+  const char* pcTaskName;
+  UBaseType_t uxCurrentPriority;
+  uint32_t ulRunTimeCounter;
+  uint32_t usStackHighWaterMark;
+  BaseType_t xCoreID;
+} TaskStatus_t;
+
+UBaseType_t uxTaskGetNumberOfTasks();
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* taskStatusArray, UBaseType_t arraySize,
+                                 uint32_t* totalRunTime);
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpuId);
+
+// Direct-to-task notifications
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
+
+void vPortYield();
+#define taskYIELD() vPortYield()
+
+#endif // HOST_FREERTOS_TASK_H
@@ -0,0 +1,13 @@
+// host_main.cpp (host shim)
+// Arduino entry point: the main thread plays the role of the loop task.
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+int main() {
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  setup();
+  for (;;) loop();
+  return 0;
+}
@@ -0,0 +1,493 @@
+// host_runtime.cpp (host shim)
+// Implementations behind the host shim headers: time, Serial, heap accounting,
+// FreeRTOS tasks/semaphores on std::thread, WiFiUDP on POSIX sockets and the
+// synthetic JPEG decoder.
+#include "Arduino.h"
+#include "WiFi.h"
+#include "WiFiUdp.h"
+#include "TJpg_Decoder.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Time
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+static std::atomic<bool> virtualTime(false);
+static std::atomic<uint64_t> virtualTimeUs(0);
+
+static uint64_t uptimeUs() {
+  if (virtualTime.load(std::memory_order_relaxed)) return virtualTimeUs.load(std::memory_order_relaxed);
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - bootTime).count();
+}
+
+uint32_t millis() { return (uint32_t)(uptimeUs() / 1000); }
+uint32_t micros() { return (uint32_t)uptimeUs(); }
+
+void hostUseVirtualTime(uint64_t startUs) {
+  virtualTimeUs.store(startUs);
+  virtualTime.store(true);
+}
+
+void hostAdvanceTime(uint32_t us) { virtualTimeUs.fetch_add(us); }
+
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+// ---------------------------------------------------------------------------
+// Serial / Print
+
+HardwareSerial Serial;
+
+size_t Print::printf(const char* format, ...) {
+  char stackBuf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(stackBuf, sizeof(stackBuf), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if ((size_t)len < sizeof(stackBuf)) return write((const uint8_t*)stackBuf, len);
+  
+  char* heapBuf = (char*)malloc(len + 1);
+  if (!heapBuf) return 0;
+  va_start(args, format);
+  vsnprintf(heapBuf, len + 1, format, args);
+  va_end(args);
+  size_t written = write((const uint8_t*)heapBuf, len);
+  free(heapBuf);
+  return written;
+}
+
+int HardwareSerial::available() {
+  struct pollfd pfd = { 0, POLLIN, 0 };
+  return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) ? 1 : 0;
+}
+
+int HardwareSerial::read() {
+  if (!available()) return -1;
+  unsigned char c;
+  return ::read(0, &c, 1) == 1 ? c : -1;
+}
+
+// ---------------------------------------------------------------------------
+// Heap accounting
+//
+// HOST_HEAP_KB sets the simulated heap (default: what a plain WROOM-32 has
+// left after WiFi AP start-up), so allocation fallbacks are exercised.
+
+static std::atomic<size_t> heapUsed(0);
+static std::atomic<size_t> heapLowWater(0);
+
+static size_t heapBudget() {
+  static size_t budget = 0;
+  if (budget == 0) {
+    const char* env = getenv("HOST_HEAP_KB");
+    budget = (env ? (size_t)atoi(env) : 240) * 1024;
+  }
+  return budget;
+}
+
+struct HeapHeader { size_t size; size_t pad; };
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+  (void)caps;
+  if (heapUsed.load() + size > heapBudget()) return nullptr;
+  HeapHeader* h = (HeapHeader*)malloc(sizeof(HeapHeader) + size);
+  if (!h) return nullptr;
+  h->size = size;
+  size_t used = heapUsed.fetch_add(size) + size;
+  size_t freeNow = heapBudget() - used;
+  size_t low = heapLowWater.load();
+  while ((low == 0 || freeNow < low) && !heapLowWater.compare_exchange_weak(low, freeNow)) {}
+  return h + 1;
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  void* p = heap_caps_malloc(n * size, caps);
+  if (p) memset(p, 0, n * size);
+  return p;
+}
+
+void heap_caps_free(void* ptr) {
+  if (!ptr) return;
+  HeapHeader* h = (HeapHeader*)ptr - 1;
+  heapUsed.fetch_sub(h->size);
+  free(h);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  if (caps & MALLOC_CAP_SPIRAM) return 0;
+  return heapBudget() - heapUsed.load();
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return heap_caps_get_free_size(caps);
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getFreeHeap() { return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT); }
+
+uint32_t EspClass::getMinFreeHeap() {
+  size_t low = heapLowWater.load();
+  return (uint32_t)(low ? low : heapBudget());
+}
+
+uint32_t EspClass::getCycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+  uint32_t lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return lo;
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// FreeRTOS
+
+struct HostTask {
+  TaskFunction_t code;
+  void* parameters;
+  const char* name;
+  uint32_t stackDepth;
+  UBaseType_t priority;
+  BaseType_t coreId;
+  std::atomic<bool> hasCpuClock;
+  clockid_t cpuClock;
+  std::mutex notifyMutex;
+  std::condition_variable notifyCv;
+  uint32_t notifyValue;
+};
+
+struct TaskExit {};
+
+static thread_local HostTask* currentTask = nullptr;
+static std::mutex taskListMutex;
+static std::vector<HostTask*> taskList;
+static HostTask idleTasks[2];
+
+BaseType_t xPortGetCoreID() { return currentTask ? currentTask->coreId : 0; }
+
+static void taskTrampoline(HostTask* task) {
+  currentTask = task;
+  if (pthread_getcpuclockid(pthread_self(), &task->cpuClock) == 0) task->hasCpuClock = true;
+  try {
+    task->code(task->parameters);
+  } catch (const TaskExit&) {
+  }
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority,
+                                   TaskHandle_t* createdTask, BaseType_t coreId) {
+  HostTask* task = new HostTask();
+  task->code = code;
+  task->parameters = parameters;
+  task->name = name;
+  task->stackDepth = stackDepth;
+  task->priority = priority;
+  task->coreId = coreId < 0 ? 0 : coreId;
+  task->hasCpuClock = false;
+  task->notifyValue = 0;
+  if (createdTask) *createdTask = task;
+  {
+    std::lock_guard<std::mutex> lock(taskListMutex);
+    taskList.push_back(task);
+  }
+  std::thread(taskTrampoline, task).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == currentTask) {
+    if (currentTask) throw TaskExit();
+    // The Arduino "loop task" (main thread) deletes itself after setup():
+    // park it forever, the firmware tasks keep the process alive.
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+  // Threads cannot be killed from outside; the task simply keeps running
+  // until the process exits.
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCount() { return millis() / portTICK_PERIOD_MS; }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return currentTask; }
+const char* pcTaskGetName(TaskHandle_t task) {
+  HostTask* t = task ? task : currentTask;
+  return t ? t->name : "main";
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  // Stack usage is not observable on the host; report the full allocation.
+  HostTask* t = task ? task : currentTask;
+  return t ? t->stackDepth : 0;
+}
+
+static uint64_t cpuTimeUs(const HostTask* task) {
+  struct timespec ts;
+  if (!task->hasCpuClock || clock_gettime(task->cpuClock, &ts) != 0) return 0;
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+  std::lock_guard<std::mutex> lock(taskListMutex);
+  return taskList.size() + 2;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* taskStatusArray, UBaseType_t arraySize,
+                                 uint32_t* totalRunTime) {
+  std::lock_guard<std::mutex> lock(taskListMutex);
+  if (arraySize < taskList.size() + 2) return 0;
+  
+  // Deleted tasks keep running on the host (see vTaskDelete) and stay listed
+  uint64_t now = uptimeUs();
+  uint64_t busy[2] = { 0, 0 };
+  UBaseType_t count = 0;
+  for (HostTask* task : taskList) {
+    uint64_t runTime = cpuTimeUs(task);
+    busy[task->coreId & 1] += runTime;
+    taskStatusArray[count++] = { task, task->name, task->priority, (uint32_t)runTime,
+                                 task->stackDepth, task->coreId };
+  }
+  for (BaseType_t core = 0; core < 2; core++) {
+    HostTask* idle = &idleTasks[core];
+    uint64_t idleTime = now > busy[core] ? now - busy[core] : 0;
+    taskStatusArray[count++] = { idle, core ? "IDLE1" : "IDLE0", 0, (uint32_t)idleTime, 1024, core };
+  }
+  if (totalRunTime) *totalRunTime = (uint32_t)now;
+  return count;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpuId) {
+  return cpuId < 2 ? &idleTasks[cpuId] : nullptr;
+}
+
+void vPortYield() { std::this_thread::yield(); }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (!task) return pdFAIL;
+  {
+    std::lock_guard<std::mutex> lock(task->notifyMutex);
+    task->notifyValue++;
+  }
+  task->notifyCv.notify_one();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  HostTask* task = currentTask;
+  if (!task) return 0;
+  std::unique_lock<std::mutex> lock(task->notifyMutex);
+  auto ready = [task] { return task->notifyValue > 0; };
+  if (ticksToWait == portMAX_DELAY) {
+    task->notifyCv.wait(lock, ready);
+  } else {
+    task->notifyCv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready);
+  }
+  uint32_t value = task->notifyValue;
+  if (value) task->notifyValue = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+struct HostSemaphore {
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t count;
+};
+
+static SemaphoreHandle_t createSemaphore(uint32_t initialCount) {
+  HostSemaphore* sem = new HostSemaphore();
+  sem->count = initialCount;
+  return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return createSemaphore(1); }
+SemaphoreHandle_t xSemaphoreCreateBinary() { return createSemaphore(0); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticksToWait) {
+  if (!sem) return pdFALSE;
+  std::unique_lock<std::mutex> lock(sem->mutex);
+  auto ready = [sem] { return sem->count > 0; };
+  if (ticksToWait == portMAX_DELAY) {
+    sem->cv.wait(lock, ready);
+  } else if (!sem->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready)) {
+    return pdFALSE;
+  }
+  sem->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  if (!sem) return pdFALSE;
+  {
+    std::lock_guard<std::mutex> lock(sem->mutex);
+    if (sem->count > 0) return pdFALSE;
+    sem->count = 1;
+  }
+  sem->cv.notify_one();
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+// ---------------------------------------------------------------------------
+// WiFi / WiFiUDP
+
+WiFiClass WiFi;
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+  stop();
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return 0;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    stop();
+    return 0;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  if (fd >= 0) { close(fd); fd = -1; }
+  rxLen = rxPos = 0;
+}
+
+int WiFiUDP::parsePacket() {
+  rxLen = rxPos = 0;
+  if (fd < 0) return 0;
+  struct sockaddr_in from;
+  socklen_t fromLen = sizeof(from);
+  ssize_t n = recvfrom(fd, rxBuf, sizeof(rxBuf), 0, (struct sockaddr*)&from, &fromLen);
+  if (n <= 0) return 0;
+  rxLen = (size_t)n;
+  rxAddr = IPAddress(from.sin_addr.s_addr);
+  rxPort = ntohs(from.sin_port);
+  return (int)n;
+}
+
+int WiFiUDP::read() {
+  return rxPos < rxLen ? rxBuf[rxPos++] : -1;
+}
+
+int WiFiUDP::read(uint8_t* buffer, size_t len) {
+  size_t n = std::min(len, rxLen - rxPos);
+  memcpy(buffer, rxBuf + rxPos, n);
+  rxPos += n;
+  return (int)n;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  txAddr = ip;
+  txPort = port;
+  txLen = 0;
+  return 1;
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+  struct in_addr addr;
+  if (inet_pton(AF_INET, host, &addr) != 1) return 0;
+  return beginPacket(IPAddress(addr.s_addr), port);
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size) {
+  size_t n = std::min(size, sizeof(txBuf) - txLen);
+  memcpy(txBuf + txLen, buffer, n);
+  txLen += n;
+  return n;
+}
+
+int WiFiUDP::endPacket() {
+  int sock = fd >= 0 ? fd : socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0) return 0;
+  struct sockaddr_in to;
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_port = htons(txPort);
+  to.sin_addr.s_addr = (uint32_t)txAddr;
+  ssize_t sent = sendto(sock, txBuf, txLen, 0, (struct sockaddr*)&to, sizeof(to));
+  if (sock != fd) close(sock);
+  txLen = 0;
+  return sent >= 0 ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// TJpg_Decoder
+
+TJpg_Decoder TJpgDec;
+
+JRESULT TJpg_Decoder::getJpgSize(uint16_t* w, uint16_t* h, const uint8_t* data, uint32_t size) {
+  if (!data || size < 4 || data[0] != 0xFF || data[1] != 0xD8) return JDR_FMT1;
+  uint32_t i = 2;
+  while (i + 9 < size) {
+    if (data[i] != 0xFF) return JDR_FMT1;
+    uint8_t marker = data[i + 1];
+    uint16_t segLen = (uint16_t)((data[i + 2] << 8) | data[i + 3]);
+    if (marker == 0xC0 || marker == 0xC1) {
+      *h = (uint16_t)((data[i + 5] << 8) | data[i + 6]);
+      *w = (uint16_t)((data[i + 7] << 8) | data[i + 8]);
+      return JDR_OK;
+    }
+    i += 2 + segLen;
+  }
+  return JDR_FMT1;
+}
+
+JRESULT TJpg_Decoder::drawJpg(int32_t x, int32_t y, const uint8_t* data, uint32_t size) {
+  uint16_t w = 0, h = 0;
+  JRESULT res = getJpgSize(&w, &h, data, size);
+  if (res != JDR_OK) return res;
+  w /= scale;
+  h /= scale;
+  if (!callback) return JDR_OK;
+  
+  // Camera JPEGs are YUV 4:2:2, which TJpgDec emits as 16x8 MCUs.
+  const uint16_t mcuW = 16, mcuH = 8;
+  uint32_t seed = size;
+  for (uint16_t my = 0; my < h; my += mcuH) {
+    for (uint16_t mx = 0; mx < w; mx += mcuW) {
+      uint16_t bw = std::min<uint16_t>(mcuW, w - mx);
+      uint16_t bh = std::min<uint16_t>(mcuH, h - my);
+      uint32_t src = ((uint32_t)(my / mcuH) * ((w + mcuW - 1) / mcuW) + mx / mcuW) % size;
+      seed = seed * 1103515245u + data[src];
+      uint16_t color = (uint16_t)(seed >> 16);
+      for (uint32_t i = 0; i < (uint32_t)bw * bh; i++) mcuBuffer[i] = (uint16_t)(color + (i & 7));
+      if (swap) {
+        for (uint32_t i = 0; i < (uint32_t)bw * bh; i++) {
+          mcuBuffer[i] = (uint16_t)((mcuBuffer[i] << 8) | (mcuBuffer[i] >> 8));
+        }
+      }
+      if (!callback((int16_t)(x + mx), (int16_t)(y + my), bw, bh, mcuBuffer)) return JDR_INTR;
+    }
+  }
+  return JDR_OK;
+}
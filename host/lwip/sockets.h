@@ -0,0 +1,15 @@
+// lwip/sockets.h (host shim)
+// lwIP exposes the BSD socket API; on Linux the native headers are used directly.
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,270 @@
+// capture_replay.cpp (host runner)
+// Feeds a packet capture back into the real FrameProcessor. The default timed
+// mode replays every datagram at its recorded time on a virtual clock, with
+// the UDP task's timeout tick and the display task's polling in between, so a
+// field capture reproduces the same completions and drops on every run. Fast
+// mode feeds the datagrams back to back on the wall clock as a benchmark.
+//
+//   capture_replay [options] CAPTURE
+//     --fast             As fast as possible instead of the recorded pace
+//     --repeat N         Fast mode: replay N times (default 1)
+//     --frames           Print every displayed frame
+//     --trace            Print the event trace of the replay (for tools/trace_to_chrome)
+//
+// CAPTURE is a binary capture (host CAPTURE_FILE) or a serial log holding a
+// "capture dump" from the device. Device records snapped to
+// CAPTURE_SNAP_LENGTH are zero-filled to their original length, which keeps
+// reassembly behaviour but fails JPEG validation.
+#include "Arduino.h"
+#include "config.h"
+#include "frame_processor.h"
+#include "performance_monitor.h"
+#include "packet_capture.h"
+#include "trace_recorder.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct CaptureRecord {
+  uint32_t timeUs;
+  std::vector<uint8_t> data;   // Original length, snapped bytes zero-filled
+  bool snapped;
+};
+
+struct ReplayOptions {
+  const char* path = nullptr;
+  bool fast = false;
+  uint32_t repeat = 1;
+  bool listFrames = false;
+  bool trace = false;
+};
+
+static const uint32_t DISPLAY_POLL_US = 8000;          // highSpeedDisplayTask delay
+static const uint32_t TICK_US = Config::FRAME_TIMEOUT_CHECK_INTERVAL * 1000;
+static const uint32_t DRAIN_US = 500000;               // Lets the last frames time out
+
+static bool readFile(const char* path, std::vector<uint8_t>& contents) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) contents.insert(contents.end(), chunk, chunk + n);
+  fclose(f);
+  return true;
+}
+
+// Extracts the hex lines between CAPTURE BEGIN and CAPTURE END of a serial log
+static bool decodeSerialDump(const std::vector<uint8_t>& log, std::vector<uint8_t>& capture) {
+  std::string text(log.begin(), log.end());
+  size_t begin = text.find("CAPTURE BEGIN");
+  size_t end = text.find("CAPTURE END", begin);
+  if (begin == std::string::npos || end == std::string::npos) return false;
+  
+  begin = text.find('\n', begin);
+  int high = -1;
+  for (size_t i = begin; i < end; i++) {
+    int digit = isdigit(text[i]) ? text[i] - '0' :
+                (text[i] >= 'a' && text[i] <= 'f') ? text[i] - 'a' + 10 : -1;
+    if (digit < 0) continue;
+    if (high < 0) {
+      high = digit;
+    } else {
+      capture.push_back((uint8_t)(high << 4 | digit));
+      high = -1;
+    }
+  }
+  return true;
+}
+
+static bool loadCapture(const char* path, std::vector<CaptureRecord>& records) {
+  std::vector<uint8_t> contents;
+  if (!readFile(path, contents)) {
+    fprintf(stderr, "Cannot read %s\n", path);
+    return false;
+  }
+  
+  std::vector<uint8_t> capture;
+  if (contents.size() >= 4 && WireProto::load32(contents.data()) == CaptureFormat::MAGIC) {
+    capture.swap(contents);
+  } else if (!decodeSerialDump(contents, capture)) {
+    fprintf(stderr, "%s: neither a capture file nor a serial log with a capture dump\n", path);
+    return false;
+  }
+  
+  if (capture.size() < CaptureFormat::FILE_HEADER_SIZE ||
+      WireProto::load32(capture.data()) != CaptureFormat::MAGIC ||
+      WireProto::load16(capture.data() + 4) != CaptureFormat::VERSION) {
+    fprintf(stderr, "%s: unsupported capture header\n", path);
+    return false;
+  }
+  
+  size_t offset = WireProto::load16(capture.data() + 6);
+  while (offset + CaptureFormat::RECORD_HEADER_SIZE <= capture.size()) {
+    const uint8_t* header = capture.data() + offset;
+    uint16_t captured = WireProto::load16(header + 4);
+    uint16_t original = WireProto::load16(header + 6);
+    offset += CaptureFormat::RECORD_HEADER_SIZE;
+    if (offset + captured > capture.size() || captured > original) {
+      fprintf(stderr, "%s: truncated record at byte %zu\n", path, offset);
+      break;
+    }
+    
+    CaptureRecord record;
+    record.timeUs = WireProto::load32(header);
+    record.data.assign(original, 0);
+    memcpy(record.data.data(), capture.data() + offset, captured);
+    record.snapped = captured < original;
+    records.push_back(record);
+    offset += captured;
+  }
+  return !records.empty();
+}
+
+static uint32_t displayFrame(FrameProcessor& fp, const ReplayOptions& opt, uint64_t now) {
+  if (!fp.isFrameComplete()) return 0;
+  
+  uint32_t shown = 0;
+  if (fp.assembleCompleteFrame()) {
+    shown = 1;
+    if (opt.listFrames) {
+      CompleteFrameState& frame = fp.getCurrentFrame();
+      printf("%10.3f ms  frame %u, %u bytes\n", now / 1000.0, frame.frameId, frame.totalSize);
+    }
+  }
+  fp.resetCurrentFrame();
+  return shown;
+}
+
+// Recorded pace on a virtual clock: same capture, same result
+static uint32_t replayTimed(const std::vector<CaptureRecord>& records, const ReplayOptions& opt) {
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  uint8_t request[WireProto::NACK_MAX_SIZE];
+  uint32_t shown = 0;
+  uint32_t requests = 0;
+  
+  uint64_t now = records.front().timeUs;
+  hostUseVirtualTime(now);
+  uint64_t nextDisplayPoll = now;
+  uint64_t nextTick = now + TICK_US;
+  
+  // Capture times are 32-bit micros(); unwrap them while walking forward
+  uint64_t recordTime = now;
+  uint32_t previous = records.front().timeUs;
+  
+  auto advanceTo = [&](uint64_t target) {
+    while (true) {
+      uint64_t next = std::min(nextDisplayPoll, nextTick);
+      if (next > target) break;
+      hostAdvanceTime((uint32_t)(next - now));
+      now = next;
+      if (now == nextDisplayPoll) {
+        shown += displayFrame(fp, opt, now);
+        nextDisplayPoll += DISPLAY_POLL_US;
+      }
+      if (now == nextTick) {
+        fp.handleFrameTimeout();
+        while (fp.buildRetransmitRequest(request, sizeof(request)) > 0) requests++;
+        nextTick += TICK_US;
+      }
+    }
+    hostAdvanceTime((uint32_t)(target - now));
+    now = target;
+  };
+  
+  std::vector<uint8_t> datagram;
+  for (const CaptureRecord& record : records) {
+    recordTime += (uint32_t)(record.timeUs - previous);
+    previous = record.timeUs;
+    advanceTo(recordTime);
+    
+    datagram = record.data;
+    fp.processPacket(datagram.data(), datagram.size());
+  }
+  advanceTo(now + DRAIN_US);
+  
+  double seconds = (recordTime - records.front().timeUs) / 1e6;
+  printf("Replayed %zu datagrams over %.2f s of capture: %u frames shown, %u retransmit requests (not answered)\n",
+         records.size(), seconds, shown, requests);
+  return shown;
+}
+
+// Back to back on the wall clock: how fast the receive path can go
+static uint32_t replayFast(const std::vector<CaptureRecord>& records, const ReplayOptions& opt) {
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  std::vector<std::vector<uint8_t>> datagrams;
+  uint64_t bytes = 0;
+  for (const CaptureRecord& record : records) {
+    datagrams.push_back(record.data);
+    bytes += record.data.size();
+  }
+  
+  uint32_t shown = 0;
+  double seconds = 0;
+  for (uint32_t pass = 0; pass < opt.repeat; pass++) {
+    // Fresh reassembly state so frame ids replay as new, outside the timing
+    fp.cleanup();
+    fp.initialize();
+    std::vector<std::vector<uint8_t>> copy = datagrams;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (std::vector<uint8_t>& datagram : copy) {
+      fp.processPacket(datagram.data(), datagram.size());
+      shown += displayFrame(fp, opt, micros());
+    }
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  
+  uint64_t packets = (uint64_t)records.size() * opt.repeat;
+  printf("Replayed %llu datagrams in %.3f s: %.0f packets/s, %.1f MB/s, %.0f frames/s (%u frames shown)\n",
+         (unsigned long long)packets, seconds, packets / seconds,
+         bytes * opt.repeat / seconds / 1e6, shown / seconds, shown);
+  return shown;
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [--fast] [--repeat N] [--frames] [--trace] CAPTURE\n", name);
+}
+
+int main(int argc, char** argv) {
+  ReplayOptions opt;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--fast") opt.fast = true;
+    else if (arg == "--frames") opt.listFrames = true;
+    else if (arg == "--trace") opt.trace = true;
+    else if (arg == "--repeat" && i + 1 < argc) opt.repeat = std::max(1, atoi(argv[++i]));
+    else if (arg[0] != '-' && !opt.path) opt.path = argv[i];
+    else { usage(argv[0]); return 2; }
+  }
+  if (!opt.path) {
+    usage(argv[0]);
+    return 2;
+  }
+  
+  std::vector<CaptureRecord> records;
+  if (!loadCapture(opt.path, records)) return 1;
+  
+  size_t snapped = 0;
+  for (const CaptureRecord& record : records) snapped += record.snapped;
+  printf("%s: %zu datagrams%s\n", opt.path, records.size(),
+         snapped ? " (snapped, payloads zero-filled)" : "");
+  
+  Serial.setMuted(true);
+  if (!FrameProcessor::getInstance().initialize()) {
+    fprintf(stderr, "Frame processor initialization failed\n");
+    return 1;
+  }
+  if (opt.trace) TraceRecorder::getInstance().start();
+  
+  if (opt.fast) {
+    replayFast(records, opt);
+  } else {
+    replayTimed(records, opt);
+  }
+  
+  Serial.setMuted(false);
+  PerformanceMonitor::getInstance().printStatistics();
+  if (opt.trace) TraceRecorder::getInstance().dump();
+  return 0;
+}
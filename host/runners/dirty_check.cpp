@@ -0,0 +1,129 @@
+// dirty_check.cpp (host runner)
+// Checks the delta updates. DirtyBlockMap gets hand-made strips whose change
+// masks are known: an unchanged strip, every block changed, one pixel changed
+// in a single block, a band moved, and the map invalidated. The display path
+// then renders generated frames through DisplayManager: a repeated frame must
+// send no blocks, while the first frame after clearScreen() or a viewport
+// change must send all of them.
+// Prints one line per case and exits non-zero if any case fails.
+//
+//   dirty_check
+#include "Arduino.h"
+#include "config.h"
+#include "dirty_blocks.h"
+#include "display_manager.h"
+#include "performance_monitor.h"
+#include "stream_source.h"
+
+#include <vector>
+
+static const uint16_t STRIP_ROWS = 16;
+static int caseCount = 0;
+
+static bool report(const char* name, uint64_t changed, uint64_t expected) {
+  bool pass = changed == expected;
+  caseCount++;
+  printf("%-22s changed %016llx  expected %016llx  %s\n", name, (unsigned long long)changed,
+         (unsigned long long)expected, pass ? "ok" : "FAIL");
+  return pass;
+}
+
+static bool reportPercent(const char* name, float changed, float expected) {
+  bool pass = changed == expected;
+  caseCount++;
+  printf("%-22s changed %6.1f%% of blocks  expected %6.1f%%  %s\n", name, changed, expected,
+         pass ? "ok" : "FAIL");
+  return pass;
+}
+
+// 426 pixels wide, so the last of its 27 blocks is a short one
+static int runMapCases() {
+  const uint16_t width = 426;
+  const uint64_t all = DirtyBlockMap::allBlocks(width);
+  std::vector<uint16_t> strip(width * STRIP_ROWS);
+  for (uint32_t i = 0; i < strip.size(); i++) strip[i] = (uint16_t)(i * 2654435761u >> 16);
+  
+  DirtyBlockMap map;
+  if (!map.initialize(Config::DISPLAY_WIDTH, Config::DISPLAY_HEIGHT, 8)) {
+    fprintf(stderr, "Dirty block map allocation failed\n");
+    return 1;
+  }
+  
+  int failures = 0;
+  if (!report("first-strip", map.update(0, 0, strip.data(), width, STRIP_ROWS), all)) failures++;
+  if (!report("unchanged", map.update(0, 0, strip.data(), width, STRIP_ROWS), 0)) failures++;
+  
+  // Last pixel of block 7, bottom row: the block's far corner
+  strip[(STRIP_ROWS - 1) * width + 8 * DirtyBlockMap::BLOCK_WIDTH - 1] ^= 0x0001;
+  if (!report("single-block", map.update(0, 0, strip.data(), width, STRIP_ROWS), 1ULL << 7)) failures++;
+  
+  strip[width - 1] ^= 0x8000;
+  if (!report("short-last-block", map.update(0, 0, strip.data(), width, STRIP_ROWS), 1ULL << 26)) failures++;
+  
+  for (uint16_t x = 0; x < width; x += DirtyBlockMap::BLOCK_WIDTH) strip[x] ^= 0x0020;
+  if (!report("all-changed", map.update(0, 0, strip.data(), width, STRIP_ROWS), all)) failures++;
+  
+  // Same pixels, but the band now starts one row lower
+  if (!report("band-moved", map.update(0, 1, strip.data(), width, STRIP_ROWS), all)) failures++;
+  if (!report("band-settled", map.update(0, 1, strip.data(), width, STRIP_ROWS), 0)) failures++;
+  
+  map.invalidate();
+  if (!report("viewport-reset", map.update(0, 1, strip.data(), width, STRIP_ROWS), all)) failures++;
+  
+  map.cleanup();
+  return failures;
+}
+
+static float render(std::vector<uint8_t>& frame) {
+  PerformanceMonitor::getInstance().reset();
+  if (!DisplayManager::getInstance().renderFrameHighSpeed(frame.data(), frame.size())) return -1.0f;
+  return PerformanceMonitor::getInstance().getChangedBlockRatio();
+}
+
+static int runDisplayCases() {
+  DisplayManager& dm = DisplayManager::getInstance();
+  std::vector<uint8_t> qvga;
+  std::vector<uint8_t> wide;
+  StreamSource::generateFrame(qvga, 1, 20000, 320, 240);
+  StreamSource::generateFrame(wide, 2, 20000, 480, 272);
+  
+  int failures = 0;
+  if (!reportPercent("display-first-frame", render(qvga), 100.0f)) failures++;
+  if (!reportPercent("display-repeat", render(qvga), 0.0f)) failures++;
+  
+  dm.clearScreen();
+  if (!reportPercent("display-after-clear", render(qvga), 100.0f)) failures++;
+  if (!reportPercent("display-repeat", render(qvga), 0.0f)) failures++;
+  
+  // 480x272 moves the viewport to (0, 24), and the QVGA frame moves it back
+  if (!reportPercent("display-viewport-wide", render(wide), 100.0f)) failures++;
+  if (!reportPercent("display-viewport-back", render(qvga), 100.0f)) failures++;
+  if (!reportPercent("display-repeat", render(qvga), 0.0f)) failures++;
+  return failures;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+  setenv("HOST_HEAP_KB", "320", 0);
+  
+  Serial.setMuted(true);
+  DisplayManager& dm = DisplayManager::getInstance();
+  bool ready = dm.initialize() && dm.initializeStripBuffer() && dm.isDeltaEnabled();
+  Serial.setMuted(false);
+  if (!ready) {
+    fprintf(stderr, "Initialization failed (delta updates %s)\n", Config::DIRTY_BLOCKS ? "on" : "off");
+    return 1;
+  }
+  
+  int failures = runMapCases();
+  Serial.setMuted(true);
+  int displayFailures = runDisplayCases();
+  Serial.setMuted(false);
+  failures += displayFailures;
+  
+  printf("%d of %d cases passed\n", caseCount - failures, caseCount);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// fec_check.cpp (host runner)
+// Feeds hand-picked packet sequences of single frames into the real
+// FrameProcessor and checks the XOR parity rebuild: the reassembled frame must
+// match the sent bytes, and only packets that never arrive count as recovered.
+// Prints one line per case and exits non-zero if any case fails.
+//
+//   fec_check
+#include "Arduino.h"
+#include "config.h"
+#include "frame_processor.h"
+#include "performance_monitor.h"
+#include "stream_source.h"
+
+#include <set>
+#include <vector>
+
+struct FecCase {
+  const char* name;
+  uint32_t size;              // Frame bytes
+  uint8_t groupSize;
+  bool parityFirst;           // All parity packets ahead of the data
+  bool lateOriginals;         // Withheld packets still arrive, after the frame completed
+  bool expectComplete;
+  std::set<uint16_t> withheld;  // Data packets that do not arrive in order (empty: one per group)
+};
+
+// Nine full packets and a short tenth: groups of 4 leave a last group of 2
+static const uint32_t SHORT_GROUP_SIZE = 9 * WireProto::PAYLOAD_SIZE + 321;
+
+static const FecCase CASES[] = {
+  { "one-loss-per-group",     20000,            4, false, false, true,  {} },
+  { "short-group-last-lost",  SHORT_GROUP_SIZE, 4, false, false, true,  { 9 } },
+  { "short-group-full-lost",  SHORT_GROUP_SIZE, 4, false, false, true,  { 8 } },
+  { "parity-before-data",     20000,            4, true,  false, true,  {} },
+  { "reordered-not-lost",     20000,            4, true,  true,  true,  {} },
+  { "two-losses-one-group",   20000,            4, false, false, false, { 1, 2 } },
+};
+static const int CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+static bool runCase(const FecCase& test, uint32_t frameId) {
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+  uint32_t recoveredBefore = pm.getRecoveredPackets();
+  uint32_t earlyBefore = pm.getEarlyRebuilds();
+  
+  std::vector<uint8_t> data;
+  StreamSource::generateFrame(data, frameId, test.size, 320, 240);
+  WireProto::PacketHeader frame = StreamSource::frameHeader(frameId, data.size(), 0);
+  
+  std::vector<StreamSource::Packet> dataPackets;
+  std::vector<StreamSource::Packet> parityPackets;
+  StreamSource::packetizeFrame(frame, data.data(), WireProto::VERSION, test.groupSize,
+                               [&](const StreamSource::Packet& packet, bool isParity) {
+    (isParity ? parityPackets : dataPackets).push_back(packet);
+  });
+  
+  // Default loss pattern: a different position in every group
+  std::set<uint16_t> withheld = test.withheld;
+  if (withheld.empty()) {
+    for (uint16_t first = 0; first < frame.totalPackets; first += test.groupSize) {
+      uint16_t groupEnd = std::min<uint16_t>(first + test.groupSize, frame.totalPackets);
+      withheld.insert(std::min<uint16_t>(first + (first / test.groupSize) % test.groupSize, groupEnd - 1));
+    }
+  }
+  
+  // Send order: data with each group's parity after it, or all parity first
+  std::vector<StreamSource::Packet> sequence;
+  if (test.parityFirst) sequence = parityPackets;
+  for (uint16_t index = 0; index < frame.totalPackets; index++) {
+    if (!withheld.count(index)) sequence.push_back(dataPackets[index]);
+    bool groupDone = (index + 1) % test.groupSize == 0 || index == frame.totalPackets - 1;
+    if (!test.parityFirst && groupDone) sequence.push_back(parityPackets[index / test.groupSize]);
+  }
+  if (test.lateOriginals) {
+    for (uint16_t index : withheld) sequence.push_back(dataPackets[index]);
+  }
+  
+  for (StreamSource::Packet& packet : sequence) {
+    fp.processPacket(packet.data(), packet.size());
+  }
+  
+  bool complete = fp.isFrameComplete() && fp.assembleCompleteFrame();
+  bool matches = complete && fp.getCurrentFrame().totalSize == data.size() &&
+                 memcmp(fp.getFrameBuffer(), data.data(), data.size()) == 0;
+  fp.resetCurrentFrame();
+  
+  uint32_t recovered = pm.getRecoveredPackets() - recoveredBefore;
+  uint32_t early = pm.getEarlyRebuilds() - earlyBefore;
+  uint32_t expectRecovered = test.expectComplete && !test.lateOriginals ? withheld.size() : 0;
+  uint32_t expectEarly = test.lateOriginals ? withheld.size() : 0;
+  bool pass = complete == test.expectComplete && matches == test.expectComplete &&
+              recovered == expectRecovered && early == expectEarly;
+  
+  printf("%-24s %3u packets %2u withheld  %-10s recovered %2u/%-2u early %2u/%-2u  %s\n",
+         test.name, frame.totalPackets, (unsigned)withheld.size(),
+         complete ? (matches ? "intact" : "CORRUPT") : "incomplete",
+         recovered, expectRecovered, early, expectEarly, pass ? "ok" : "FAIL");
+  return pass;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+  setenv("HOST_HEAP_KB", "320", 0);
+  
+  Serial.setMuted(true);
+  if (!Config::FEC_ENABLED || !FrameProcessor::getInstance().initialize()) {
+    Serial.setMuted(false);
+    fprintf(stderr, "Initialization failed (FEC %s)\n", Config::FEC_ENABLED ? "on" : "off");
+    return 1;
+  }
+  
+  int failures = 0;
+  for (int i = 0; i < CASE_COUNT; i++) {
+    if (!runCase(CASES[i], i + 1)) failures++;
+  }
+  
+  FrameProcessor::getInstance().cleanup();
+  printf("%d of %d cases passed\n", CASE_COUNT - failures, CASE_COUNT);
+  return failures ? 1 : 0;
+}
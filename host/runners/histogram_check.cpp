@@ -0,0 +1,95 @@
+// histogram_check.cpp (host runner)
+// Checks LatencyHistogram against known values: every bucket boundary, and
+// percentiles over hand-picked sample sets whose answers are worked out
+// below. Prints one line per case and exits non-zero if any case fails.
+//
+//   histogram_check
+#include "latency_histogram.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+struct PercentileCase {
+  const char* name;
+  std::vector<uint32_t> samples;
+  uint32_t p50, p90, p99;     // Expected bucket upper bounds, capped at the maximum
+};
+
+static std::vector<uint32_t> range(uint32_t first, uint32_t last) {
+  std::vector<uint32_t> values;
+  for (uint32_t v = first; v <= last; v++) values.push_back(v);
+  return values;
+}
+
+static bool checkBuckets() {
+  uint32_t failures = 0;
+  
+  // Buckets tile the whole range: each one starts right after the previous
+  // bound, and both of its ends map back to it
+  uint32_t lower = 0;
+  for (uint16_t bucket = 0; bucket < LatencyHistogram::BUCKET_COUNT; bucket++) {
+    uint32_t upper = LatencyHistogram::bucketUpperBound(bucket);
+    bool ok = upper >= lower &&
+              LatencyHistogram::bucketFor(lower) == bucket &&
+              LatencyHistogram::bucketFor(upper) == bucket;
+    
+    // Four buckets per power of two: no bucket wider than a quarter of its start
+    if (lower >= LatencyHistogram::SUB_BUCKETS && (uint64_t)(upper - lower + 1) * 4 > lower) ok = false;
+    
+    if (!ok) {
+      if (failures++ < 5) printf("  bucket %3u [%u, %u] maps to %u and %u\n", bucket, lower, upper,
+                                 LatencyHistogram::bucketFor(lower), LatencyHistogram::bucketFor(upper));
+    }
+    lower = upper + 1;
+  }
+  
+  bool coversRange = LatencyHistogram::bucketUpperBound(LatencyHistogram::BUCKET_COUNT - 1) == UINT32_MAX;
+  bool pass = failures == 0 && coversRange;
+  printf("%-22s %3u buckets, top bound %10u  %s\n", "bucket-bounds",
+         LatencyHistogram::BUCKET_COUNT,
+         LatencyHistogram::bucketUpperBound(LatencyHistogram::BUCKET_COUNT - 1), pass ? "ok" : "FAIL");
+  return pass;
+}
+
+// Ranks round to nearest: p50 of four samples is rank 2. 1..100 puts rank 50 in
+// [48,55], rank 90 in [80,95] and rank 99 in [96,111], which the maximum caps at 100.
+static const PercentileCase CASES[] = {
+  { "empty",           {},                         0,    0,    0 },
+  { "single-sample",   { 1000 },                   1000, 1000, 1000 },
+  { "exact-buckets",   { 0, 1, 2, 3 },             1,    3,    3 },
+  { "one-to-hundred",  range(1, 100),              55,   95,   100 },
+  { "outlier",         { 10, 10, 10, 10, 10, 10, 10, 10, 10, 50000 }, 11, 11, 50000 },
+};
+static const int CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+static bool runCase(const PercentileCase& test) {
+  LatencyHistogram histogram;
+  for (uint32_t sample : test.samples) histogram.record(sample);
+  
+  uint32_t p50 = histogram.getPercentile(0.50f);
+  uint32_t p90 = histogram.getPercentile(0.90f);
+  uint32_t p99 = histogram.getPercentile(0.99f);
+  bool pass = histogram.getCount() == test.samples.size() &&
+              p50 == test.p50 && p90 == test.p90 && p99 == test.p99;
+  
+  printf("%-22s %3u samples  p50 %5u/%-5u p90 %5u/%-5u p99 %5u/%-5u max %5u  %s\n",
+         test.name, histogram.getCount(), p50, test.p50, p90, test.p90, p99, test.p99,
+         histogram.getMax(), pass ? "ok" : "FAIL");
+  return pass;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+  
+  int failures = checkBuckets() ? 0 : 1;
+  for (int i = 0; i < CASE_COUNT; i++) {
+    if (!runCase(CASES[i])) failures++;
+  }
+  
+  printf("%d of %d cases passed\n", CASE_COUNT + 1 - failures, CASE_COUNT + 1);
+  return failures ? 1 : 0;
+}
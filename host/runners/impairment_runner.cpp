@@ -0,0 +1,305 @@
+// impairment_runner.cpp (host runner)
+// Replays a synthetic camera stream through NetworkImpairment into the real
+// FrameProcessor on a virtual clock, one scenario per forked process, and
+// prints how many frames each network condition lets through and how late.
+// Same seed, same options -> same table.
+//
+//   impairment_runner [options]
+//     --scenario NAME    Run only this scenario (default: all)
+//     --seed N           Impairment PRNG seed (default 1)
+//     --frames N         Frames per scenario (default 150)
+//     --fps N            Camera frame rate (default 15)
+//     --size BYTES       Frame size (default 20000)
+//     --pace-us N        Gap between packets, as the camera (default 1000)
+//     --fec N            Parity packet per N data packets, 0 = off (default 0)
+//     --wire N           Header version 1 or 2 (default 2)
+//     --rtt-us N         Display -> camera -> display round trip for NACKs (default 4000)
+//     --no-nack          Camera ignores retransmit requests
+//     --list             List the scenarios
+#include "Arduino.h"
+#include "config.h"
+#include "frame_processor.h"
+#include "performance_monitor.h"
+#include "network_impairment.h"
+#include "stream_source.h"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//  name          loss    burst in/out/loss        reorder/delay  dup     trunc   jitter
+static const Config::ImpairmentProfile SCENARIOS[] = {
+  { "clean",      0,      0,     0,    0,          0,     0,      0,      0,      0 },
+  { "loss-1%",    0.01f,  0,     0,    0,          0,     0,      0,      0,      0 },
+  { "loss-5%",    0.05f,  0,     0,    0,          0,     0,      0,      0,      0 },
+  { "burst",      0,      0.01f, 0.2f, 0.7f,       0,     0,      0,      0,      0 },
+  { "reorder",    0,      0,     0,    0,          0.1f,  3000,   0,      0,      0 },
+  { "duplicate",  0,      0,     0,    0,          0,     0,      0.05f,  0,      0 },
+  { "truncate",   0,      0,     0,    0,          0,     0,      0,      0.02f,  0 },
+  { "jitter",     0,      0,     0,    0,          0,     0,      0,      0,      5000 },
+  { "wifi-mix",   0.005f, 0.01f, 0.3f, 0.5f,       0.01f, 3000,   0.002f, 0.001f, 2000 },
+};
+static const int SCENARIO_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+struct RunnerOptions {
+  const char* scenario = nullptr;
+  uint32_t seed = 1;
+  uint32_t frames = 150;
+  uint32_t fps = 15;
+  uint32_t size = 20000;
+  uint32_t paceUs = 1000;
+  uint8_t fecGroupSize = 0;
+  uint8_t wire = 2;
+  uint32_t rttUs = 4000;
+  bool answerNacks = true;
+};
+
+// Simulation step; every event due within a step is handled at its end
+static const uint32_t STEP_US = 50;
+static const uint32_t DISPLAY_POLL_US = 8000;          // highSpeedDisplayTask delay
+static const uint32_t TICK_US = Config::FRAME_TIMEOUT_CHECK_INTERVAL * 1000;
+static const uint32_t CAMERA_HISTORY = 2;              // RETRANSMIT_HISTORY in rtos_camfeed.ino
+
+struct ScheduledPacket {
+  uint64_t time;
+  uint64_t order;
+  StreamSource::Packet data;
+  bool operator>(const ScheduledPacket& other) const {
+    return time != other.time ? time > other.time : order > other.order;
+  }
+};
+
+typedef std::priority_queue<ScheduledPacket, std::vector<ScheduledPacket>, std::greater<ScheduledPacket>> PacketQueue;
+
+// Camera side of the link: sends frames on schedule and answers NACKs
+class CameraModel {
+public:
+  CameraModel(const RunnerOptions& options) : opt(options), order(0), packetsResent(0) {}
+  
+  void queueFrame(uint32_t frameId, uint64_t start) {
+    std::vector<uint8_t>& data = frames[frameId];
+    StreamSource::generateFrame(data, frameId, opt.size, 320, 240);
+    firstSend[frameId] = start;
+    
+    WireProto::PacketHeader frame = StreamSource::frameHeader(frameId, data.size(), (uint32_t)start);
+    uint64_t time = start;
+    StreamSource::packetizeFrame(frame, data.data(), opt.wire, opt.fecGroupSize,
+                                 [&](const StreamSource::Packet& packet, bool isParity) {
+      schedule(time, packet);
+      if (!isParity) time += opt.paceUs;
+    });
+    
+    // Frames beyond the camera's retransmit history are gone
+    if (frameId > CAMERA_HISTORY) frames.erase(frameId - CAMERA_HISTORY);
+  }
+  
+  void receiveRequest(const uint8_t* data, int size, uint64_t arrival) {
+    StreamSource::RetransmitRequest nack;
+    if (!opt.answerNacks || !StreamSource::parseRequest(data, size, nack)) return;
+    
+    auto it = frames.find(nack.frameId);
+    if (it == frames.end()) return;
+    
+    const std::vector<uint8_t>& frameData = it->second;
+    WireProto::PacketHeader frame = StreamSource::frameHeader(nack.frameId, frameData.size(),
+                                                              (uint32_t)firstSend[nack.frameId]);
+    if (frame.totalPackets != nack.totalPackets) return;
+    
+    StreamSource::Packet packet;
+    StreamSource::forEachRequestedPacket(nack, [&](uint16_t index) {
+      StreamSource::buildDataPacket(packet, frame, frameData.data(), index, WireProto::FLAG_RETRANSMIT, opt.wire);
+      schedule(arrival, packet);
+      packetsResent++;
+    });
+  }
+  
+  PacketQueue& getLink() { return link; }
+  uint64_t getFirstSend(uint32_t frameId) const {
+    auto it = firstSend.find(frameId);
+    return it != firstSend.end() ? it->second : 0;
+  }
+  uint32_t getPacketsResent() const { return packetsResent; }
+
+private:
+  const RunnerOptions& opt;
+  std::map<uint32_t, std::vector<uint8_t>> frames;
+  std::map<uint32_t, uint64_t> firstSend;
+  PacketQueue link;
+  uint64_t order;
+  uint32_t packetsResent;
+  
+  void schedule(uint64_t time, const StreamSource::Packet& packet) {
+    link.push(ScheduledPacket{ time, order++, packet });
+  }
+};
+
+struct PendingRequest {
+  uint64_t arrival;
+  StreamSource::Packet data;
+};
+
+static uint32_t percentile(std::vector<uint32_t> values, double p) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  size_t index = std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5));
+  return values[index];
+}
+
+// Runs in a fresh process so every firmware singleton starts from zero
+static int runScenario(const Config::ImpairmentProfile& profile, const RunnerOptions& opt) {
+  const uint64_t startUs = 1000000;
+  hostUseVirtualTime(startUs);
+  Serial.setMuted(true);
+  
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  NetworkImpairment& impairment = NetworkImpairment::getInstance();
+  PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+  if (!fp.initialize() || !impairment.initialize(profile, opt.seed)) {
+    fprintf(stderr, "%s: initialization failed\n", profile.name);
+    return 1;
+  }
+  
+  CameraModel camera(opt);
+  PacketQueue& link = camera.getLink();
+  std::vector<PendingRequest> requests;
+  std::vector<uint32_t> latencies;
+  uint8_t datagram[WireProto::MAX_HEADER_SIZE + WireProto::PARITY_PAYLOAD_SIZE];
+  uint8_t request[WireProto::NACK_MAX_SIZE];
+  
+  uint64_t frameInterval = 1000000 / std::max<uint32_t>(opt.fps, 1);
+  uint64_t end = startUs + opt.frames * frameInterval + 500000;
+  uint64_t nextFrameTime = startUs;
+  uint64_t nextDisplayPoll = startUs;
+  uint64_t nextTick = startUs + TICK_US;
+  uint32_t nextFrameId = 1;
+  
+  for (uint64_t now = startUs; now < end; now += STEP_US, hostAdvanceTime(STEP_US)) {
+    if (nextFrameId <= opt.frames && now >= nextFrameTime) {
+      camera.queueFrame(nextFrameId++, now);
+      nextFrameTime += frameInterval;
+    }
+    
+    // Camera -> impairment -> frame processor
+    while (!link.empty() && link.top().time <= now) {
+      const StreamSource::Packet& packet = link.top().data;
+      impairment.submit(packet.data(), packet.size(), (uint32_t)now);
+      link.pop();
+    }
+    int size;
+    while ((size = impairment.release(datagram, sizeof(datagram), (uint32_t)now)) > 0) {
+      fp.processPacket(datagram, size);
+    }
+    
+    // Display task: take whatever frame is newest when it wakes up
+    if (now >= nextDisplayPoll) {
+      nextDisplayPoll += DISPLAY_POLL_US;
+      if (fp.isFrameComplete() && fp.assembleCompleteFrame()) {
+        uint64_t sent = camera.getFirstSend(fp.getCurrentFrame().frameId);
+        if (sent) latencies.push_back((uint32_t)(now - sent));
+      }
+      fp.resetCurrentFrame();
+    }
+    
+    // UDP task tick: timeouts and retransmit requests, which reach the camera half an RTT later
+    if (now >= nextTick) {
+      nextTick += TICK_US;
+      fp.handleFrameTimeout();
+      int requestSize;
+      while ((requestSize = fp.buildRetransmitRequest(request, sizeof(request))) > 0) {
+        requests.push_back(PendingRequest{ now + opt.rttUs / 2,
+                                           StreamSource::Packet(request, request + requestSize) });
+      }
+    }
+    
+    for (size_t i = 0; i < requests.size();) {
+      if (requests[i].arrival > now) {
+        i++;
+        continue;
+      }
+      camera.receiveRequest(requests[i].data.data(), requests[i].data.size(), now + opt.rttUs / 2);
+      requests.erase(requests.begin() + i);
+    }
+  }
+  
+  uint32_t shown = latencies.size();
+  printf("%-10s %7u %6u %6.1f%% %8u %7u %6u %7u %7u %6u %6u %6u  %6.1f %6.1f %6.1f\n",
+         profile.name, opt.frames, shown, opt.frames ? shown * 100.0 / opt.frames : 0.0,
+         impairment.getDroppedPackets(), pm.getRecoveredPackets(), pm.getEarlyRebuilds(),
+         camera.getPacketsResent(),
+         pm.getRepairedFrames(), pm.getIncompleteFrames() + pm.getEvictedFrames(),
+         pm.getCorruptFrames(), pm.getSkippedFrames(),
+         percentile(latencies, 0.5) / 1000.0, percentile(latencies, 0.95) / 1000.0,
+         percentile(latencies, 1.0) / 1000.0);
+  fflush(stdout);
+  
+  impairment.cleanup();
+  fp.cleanup();
+  return 0;
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [--scenario NAME] [--seed N] [--frames N] [--fps N] [--size BYTES]\n"
+                  "       [--pace-us N] [--fec N] [--wire 1|2] [--rtt-us N] [--no-nack] [--list]\n", name);
+}
+
+int main(int argc, char** argv) {
+  RunnerOptions opt;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    
+    if (arg == "--no-nack") opt.answerNacks = false;
+    else if (arg == "--list") {
+      for (int s = 0; s < SCENARIO_COUNT; s++) printf("%s\n", SCENARIOS[s].name);
+      return 0;
+    }
+    else if (!hasValue) { usage(argv[0]); return 2; }
+    else if (arg == "--scenario") opt.scenario = argv[++i];
+    else if (arg == "--seed") opt.seed = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--frames") opt.frames = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--fps") opt.fps = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--size") opt.size = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--pace-us") opt.paceUs = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--fec") opt.fecGroupSize = atoi(argv[++i]);
+    else if (arg == "--wire") opt.wire = atoi(argv[++i]);
+    else if (arg == "--rtt-us") opt.rttUs = strtoul(argv[++i], nullptr, 0);
+    else { usage(argv[0]); return 2; }
+  }
+  if ((opt.wire != 1 && opt.wire != WireProto::VERSION)) {
+    usage(argv[0]);
+    return 2;
+  }
+  
+  printf("Seed %u, %u frames of %u bytes at %u fps, FEC %u, NACK %s, RTT %.1f ms\n",
+         opt.seed, opt.frames, opt.size, opt.fps, opt.fecGroupSize,
+         opt.answerNacks && Config::NACK_ENABLED ? "on" : "off", opt.rttUs / 1000.0);
+  printf("%-10s %7s %6s %7s %8s %7s %6s %7s %7s %6s %6s %6s  %6s %6s %6s\n",
+         "scenario", "frames", "shown", "%", "dropped", "fec", "early", "resent", "repair",
+         "lost", "corrupt", "skip", "p50ms", "p95ms", "maxms");
+  fflush(stdout);
+  
+  int failures = 0;
+  bool found = false;
+  for (int s = 0; s < SCENARIO_COUNT; s++) {
+    if (opt.scenario && strcmp(opt.scenario, SCENARIOS[s].name) != 0) continue;
+    found = true;
+    
+    pid_t pid = fork();
+    if (pid == 0) _exit(runScenario(SCENARIOS[s], opt));
+    
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failures++;
+    }
+  }
+  
+  if (!found) {
+    fprintf(stderr, "Unknown scenario '%s' (see --list)\n", opt.scenario);
+    return 2;
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+// mailbox_stress.cpp (host runner)
+// Races the frame handoff between two threads on the wall clock. The
+// producer pushes complete frames through processPacket() back to back, as
+// the UDP task would under a packet burst; the consumer takes them with
+// assembleCompleteFrame() as the display task does and holds each for a
+// while, as a decode would. The consumer checks that frame ids only ever
+// increase, and that the frame it holds still carries that frame's bytes
+// when it lets go: a buffer owned by both sides gets overwritten by the
+// producer. Every frame sent must end up either shown or counted as skipped.
+//
+//   mailbox_stress [options]
+//     --frames N         Frames to send (default 50000)
+//     --size BYTES       Frame size (default 4000)
+//     --hold-us N        Longest time the consumer holds a frame (default 200)
+#include "Arduino.h"
+#include "config.h"
+#include "frame_processor.h"
+#include "performance_monitor.h"
+#include "stream_source.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct StressOptions {
+  uint32_t frames = 50000;
+  uint32_t size = 4000;
+  uint32_t holdUs = 200;
+};
+
+struct StressResult {
+  uint32_t shown = 0;
+  uint32_t outOfOrder = 0;
+  uint32_t corrupt = 0;       // Bytes wrong when taken
+  uint32_t overwritten = 0;   // Bytes changed while held
+};
+
+static void produce(const StressOptions& opt, std::atomic<bool>& done) {
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  std::vector<uint8_t> data;
+  
+  for (uint32_t frameId = 1; frameId <= opt.frames; frameId++) {
+    StreamSource::generateFrame(data, frameId, opt.size, 320, 240);
+    WireProto::PacketHeader frame = StreamSource::frameHeader(frameId, data.size(), 0);
+    StreamSource::packetizeFrame(frame, data.data(), WireProto::VERSION, 0,
+                                 [&](const StreamSource::Packet& packet, bool isParity) {
+      fp.processPacket(const_cast<uint8_t*>(packet.data()), packet.size());
+    });
+  }
+  done.store(true, std::memory_order_release);
+}
+
+static void consume(const StressOptions& opt, std::atomic<bool>& done, StressResult& result) {
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  std::vector<uint8_t> expected;
+  uint32_t lastId = 0;
+  uint32_t hold = 1;
+  
+  // One more pass after the producer finishes picks up its last frame
+  for (bool last = false; !last;) {
+    last = done.load(std::memory_order_acquire);
+    if (!fp.isFrameComplete()) continue;
+    
+    bool valid = fp.assembleCompleteFrame();
+    CompleteFrameState& frame = fp.getCurrentFrame();
+    result.shown++;
+    if (frame.frameId <= lastId) result.outOfOrder++;
+    lastId = frame.frameId;
+    
+    StreamSource::generateFrame(expected, frame.frameId, opt.size, 320, 240);
+    bool intact = valid && frame.totalSize == expected.size() &&
+                  memcmp(fp.getFrameBuffer(), expected.data(), expected.size()) == 0;
+    if (!intact) result.corrupt++;
+    
+    // Hold it for a pseudo-random while, then check nobody wrote to it. The
+    // wait yields so the producer also gets to run on a single-core host.
+    hold = hold * 1103515245 + 12345;
+    uint32_t until = micros() + (hold >> 16) % (opt.holdUs + 1);
+    while ((int32_t)(micros() - until) < 0) std::this_thread::yield();
+    if (intact && memcmp(fp.getFrameBuffer(), expected.data(), expected.size()) != 0) {
+      result.overwritten++;
+    }
+    fp.resetCurrentFrame();
+  }
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [--frames N] [--size BYTES] [--hold-us N]\n", name);
+}
+
+int main(int argc, char** argv) {
+  StressOptions opt;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--frames" && i + 1 < argc) opt.frames = std::max(1, atoi(argv[++i]));
+    else if (arg == "--size" && i + 1 < argc) opt.size = std::max(64, atoi(argv[++i]));
+    else if (arg == "--hold-us" && i + 1 < argc) opt.holdUs = std::max(0, atoi(argv[++i]));
+    else { usage(argv[0]); return 2; }
+  }
+  if (opt.size > Config::MAX_FRAME_SIZE) {
+    usage(argv[0]);
+    return 2;
+  }
+  setenv("HOST_HEAP_KB", "320", 0);
+  
+  Serial.setMuted(true);
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  if (!fp.initialize()) {
+    Serial.setMuted(false);
+    fprintf(stderr, "Initialization failed\n");
+    return 1;
+  }
+  
+  std::atomic<bool> done(false);
+  StressResult result;
+  uint32_t startMs = millis();
+  std::thread consumer(consume, std::cref(opt), std::ref(done), std::ref(result));
+  std::thread producer(produce, std::cref(opt), std::ref(done));
+  producer.join();
+  consumer.join();
+  uint32_t elapsedMs = millis() - startMs;
+  
+  PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+  uint32_t skipped = pm.getSkippedFrames();
+  uint32_t unaccounted = opt.frames - std::min(opt.frames, result.shown + skipped);
+  printf("%u frames in %u ms: shown %u, skipped %u, unaccounted %u\n",
+         opt.frames, elapsedMs, result.shown, skipped, unaccounted);
+  printf("out of order %u, corrupt when taken %u, overwritten while held %u\n",
+         result.outOfOrder, result.corrupt, result.overwritten);
+  fp.cleanup();
+  
+  bool pass = result.shown > 0 && result.outOfOrder == 0 && result.corrupt == 0 &&
+              result.overwritten == 0 && result.shown + skipped == opt.frames;
+  printf("%s\n", pass ? "ok" : "FAIL");
+  return pass ? 0 : 1;
+}
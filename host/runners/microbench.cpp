@@ -0,0 +1,49 @@
+// microbench.cpp (host runner)
+// Runs the MicroBenchmark suite against the null display and prints its JSON,
+// the same cases and format as Config::BENCHMARK_AT_BOOT on the device, so a
+// change to a hot path can be compared before and after on either.
+//
+//   microbench [options]
+//     --ms N             Wall time per case (default Config::BENCHMARK_CASE_MS)
+//
+// Unless HOST_HEAP_KB is set, the simulated heap is 320 KB, about what a
+// WROOM-32 has free before WiFi starts.
+#include "Arduino.h"
+#include "config.h"
+#include "display_manager.h"
+#include "frame_processor.h"
+#include "micro_benchmark.h"
+
+#include <string>
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [--ms N]\n", name);
+}
+
+int main(int argc, char** argv) {
+  uint32_t caseMs = Config::BENCHMARK_CASE_MS;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--ms" && i + 1 < argc) caseMs = std::max(1, atoi(argv[++i]));
+    else { usage(argv[0]); return 2; }
+  }
+  setenv("HOST_HEAP_KB", "320", 0);
+  
+  Serial.setMuted(true);
+  if (!DisplayManager::getInstance().initialize() || !FrameProcessor::getInstance().initialize() ||
+      !DisplayManager::getInstance().initializeStripBuffer()) {
+    Serial.setMuted(false);
+    fprintf(stderr, "Initialization failed\n");
+    return 1;
+  }
+  
+  bool ran = MicroBenchmark::getInstance().run(caseMs);
+  Serial.setMuted(false);
+  if (!ran) {
+    fprintf(stderr, "Benchmark failed\n");
+    return 1;
+  }
+  
+  MicroBenchmark::getInstance().printJson();
+  return 0;
+}
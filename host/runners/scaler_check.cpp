@@ -0,0 +1,162 @@
+// scaler_check.cpp (host runner)
+// Checks FrameScaler output against values worked out by hand: 2x nearest and
+// bilinear on a small ramp, edge columns and rows that must repeat the
+// source's edge pixels, and a frame fed in decoder-sized strips that must come
+// out identical to the same frame scaled in one piece, which only holds if the
+// rows straddling two strips are blended from the carried line.
+// Prints one line per case and exits non-zero if any case fails.
+//
+//   scaler_check
+#include "Arduino.h"
+#include "config.h"
+#include "frame_scaler.h"
+
+#include <algorithm>
+#include <vector>
+
+typedef std::vector<uint16_t> Image;
+
+static uint32_t randomState = 0x2545F491;
+
+static uint16_t randomColor() {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return (uint16_t)randomState;
+}
+
+// Feeds the source sourceRows rows at a time and collects the output
+// outputRows rows per call, the way DisplayManager drives the scaler
+static Image scale(FrameScaler& scaler, const Image& source, uint16_t width, uint16_t height,
+                   uint16_t sourceRows, uint16_t outputRows) {
+  Image output(scaler.getOutputWidth() * scaler.getOutputHeight());
+  Image strip(scaler.getOutputWidth() * outputRows);
+  scaler.beginFrame();
+  
+  for (uint16_t first = 0; first < height; first += sourceRows) {
+    uint16_t rows = std::min<uint16_t>(sourceRows, height - first);
+    uint16_t produced;
+    do {
+      uint16_t done = scaler.getRowsDone();
+      produced = scaler.scaleRows(source.data() + first * width, first, rows, strip.data(), outputRows);
+      std::copy(strip.begin(), strip.begin() + produced * scaler.getOutputWidth(),
+                output.begin() + done * scaler.getOutputWidth());
+    } while (produced == outputRows);
+  }
+  return output;
+}
+
+static bool report(const char* name, uint32_t checked, uint32_t mismatches) {
+  bool pass = checked > 0 && mismatches == 0;
+  printf("%-22s %7u pixels checked  %6u wrong  %s\n", name, checked, mismatches, pass ? "ok" : "FAIL");
+  return pass;
+}
+
+// 4x4 ramp, blue = 8x and red = 8y: 2x bilinear lands on quarter positions,
+// 0 2 6 10 14 18 22 24 in both directions, clamped at the edges
+static const uint16_t RAMP_2X[8] = { 0, 2, 6, 10, 14, 18, 22, 24 };
+
+static bool checkDoubleSize(FrameScaler& scaler, Config::ScaleMode mode, const char* name) {
+  Image source(4 * 4);
+  for (uint16_t y = 0; y < 4; y++) {
+    for (uint16_t x = 0; x < 4; x++) source[y * 4 + x] = (y * 8) << 11 | x * 8;
+  }
+  
+  if (!scaler.configure(mode, 4, 4, 8, 8)) return report(name, 0, 0);
+  Image output = scale(scaler, source, 4, 4, 4, 8);
+  
+  uint32_t mismatches = 0;
+  for (uint16_t y = 0; y < 8; y++) {
+    for (uint16_t x = 0; x < 8; x++) {
+      uint16_t expected = mode == Config::SCALE_NEAREST ? source[(y / 2) * 4 + x / 2]
+                                                        : RAMP_2X[y] << 11 | RAMP_2X[x];
+      if (output[y * 8 + x] != expected) mismatches++;
+    }
+  }
+  return report(name, 64, mismatches);
+}
+
+// Source constant down each column (then along each row): the outermost output
+// columns (rows) must repeat the source's outermost pixels exactly
+static bool checkEdges(FrameScaler& scaler, Config::ScaleMode mode, uint16_t outWidth, uint16_t outHeight,
+                       const char* name) {
+  const uint16_t width = 320;
+  const uint16_t height = 240;
+  Image columns(width * height);
+  Image rows(width * height);
+  Image columnColor(width);
+  Image rowColor(height);
+  for (uint16_t x = 0; x < width; x++) columnColor[x] = randomColor();
+  for (uint16_t y = 0; y < height; y++) rowColor[y] = randomColor();
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    columns[i] = columnColor[i % width];
+    rows[i] = rowColor[i / width];
+  }
+  
+  if (!scaler.configure(mode, width, height, outWidth, outHeight)) return report(name, 0, 0);
+  Image byColumn = scale(scaler, columns, width, height, 16, 16);
+  Image byRow = scale(scaler, rows, width, height, 16, 16);
+  
+  uint32_t checked = 0;
+  uint32_t mismatches = 0;
+  for (uint16_t y = 0; y < outHeight; y++, checked += 2) {
+    if (byColumn[y * outWidth] != columnColor[0]) mismatches++;
+    if (byColumn[y * outWidth + outWidth - 1] != columnColor[width - 1]) mismatches++;
+  }
+  for (uint16_t x = 0; x < outWidth; x++, checked += 2) {
+    if (byRow[x] != rowColor[0]) mismatches++;
+    if (byRow[(outHeight - 1) * outWidth + x] != rowColor[height - 1]) mismatches++;
+  }
+  return report(name, checked, mismatches);
+}
+
+// Random QVGA frame in MCU-row strips against the same frame in one piece
+static bool checkStrips(FrameScaler& scaler, Config::ScaleMode mode, uint16_t sourceRows, uint16_t outputRows,
+                        const char* name) {
+  const uint16_t width = 320;
+  const uint16_t height = 240;
+  Image source(width * height);
+  for (uint16_t& pixel : source) pixel = randomColor();
+  
+  if (!scaler.configure(mode, width, height, 426, 320)) return report(name, 0, 0);
+  Image whole = scale(scaler, source, width, height, height, 320);
+  Image strips = scale(scaler, source, width, height, sourceRows, outputRows);
+  
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < whole.size(); i++) {
+    if (strips[i] != whole[i]) mismatches++;
+  }
+  return report(name, whole.size(), mismatches);
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+  setenv("HOST_HEAP_KB", "320", 0);
+  
+  FrameScaler scaler;
+  Serial.setMuted(true);
+  bool ready = scaler.initialize();
+  Serial.setMuted(false);
+  if (!ready) {
+    fprintf(stderr, "Initialization failed\n");
+    return 1;
+  }
+  
+  int cases = 0;
+  int failures = 0;
+  auto run = [&](bool pass) { cases++; if (!pass) failures++; };
+  run(checkDoubleSize(scaler, Config::SCALE_NEAREST, "2x-nearest"));
+  run(checkDoubleSize(scaler, Config::SCALE_BILINEAR, "2x-bilinear"));
+  run(checkEdges(scaler, Config::SCALE_NEAREST, 426, 320, "edges-nearest-426"));
+  run(checkEdges(scaler, Config::SCALE_BILINEAR, 426, 320, "edges-bilinear-426"));
+  run(checkEdges(scaler, Config::SCALE_BILINEAR, 480, 320, "edges-bilinear-480"));
+  run(checkStrips(scaler, Config::SCALE_BILINEAR, 16, 16, "strips-bilinear-16"));
+  run(checkStrips(scaler, Config::SCALE_BILINEAR, 8, 5, "strips-bilinear-8"));
+  run(checkStrips(scaler, Config::SCALE_NEAREST, 16, 16, "strips-nearest-16"));
+  
+  printf("%d of %d cases passed\n", cases - failures, cases);
+  return failures ? 1 : 0;
+}
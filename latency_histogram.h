@@ -0,0 +1,92 @@
+// latency_histogram.h
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Fixed-size microsecond histogram with four log-spaced buckets per power of
+// two (at most 25% relative error) over the whole uint32_t range. Recording
+// is two relaxed atomic updates, safe from any task on either core; readers
+// may see a sample in the count before it reaches the maximum.
+class LatencyHistogram {
+public:
+  static const uint8_t SUB_BUCKETS = 4;
+  static const uint8_t BUCKET_COUNT = 124;
+  
+  LatencyHistogram() { reset(); }
+  
+  void record(uint32_t us) {
+    counts[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    
+    uint32_t previous = maxValue.load(std::memory_order_relaxed);
+    while (us > previous &&
+           !maxValue.compare_exchange_weak(previous, us, std::memory_order_relaxed)) {}
+  }
+  
+  void reset();
+  uint32_t getCount() const;
+  uint32_t getMax() const { return maxValue.load(std::memory_order_relaxed); }
+  
+  // Upper bound of the bucket holding the given fraction of samples, capped at the maximum
+  uint32_t getPercentile(float fraction) const;
+  
+  static uint8_t bucketFor(uint32_t us) {
+    if (us < SUB_BUCKETS) return us;
+    uint8_t msb = 31 - __builtin_clz(us);
+    return (msb - 1) * SUB_BUCKETS + ((us >> (msb - 2)) & (SUB_BUCKETS - 1));
+  }
+  static uint32_t bucketUpperBound(uint8_t bucket);
+  
+private:
+  std::atomic<uint32_t> counts[BUCKET_COUNT];
+  std::atomic<uint32_t> maxValue;
+};
+
+#endif // LATENCY_HISTOGRAM_H
+
+// latency_histogram.cpp
+#include "latency_histogram.h"
+
+void LatencyHistogram::reset() {
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) counts[i].store(0, std::memory_order_relaxed);
+  maxValue.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::getCount() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) total += counts[i].load(std::memory_order_relaxed);
+  return total;
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(uint8_t bucket) {
+  if (bucket < SUB_BUCKETS) return bucket;
+  uint8_t msb = bucket / SUB_BUCKETS + 1;
+  uint32_t width = 1u << (msb - 2);
+  return ((SUB_BUCKETS + bucket % SUB_BUCKETS) << (msb - 2)) + (width - 1);
+}
+
+uint32_t LatencyHistogram::getPercentile(float fraction) const {
+  // One pass over a snapshot, so concurrent recording cannot push the rank past the end
+  uint32_t snapshot[BUCKET_COUNT];
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    snapshot[i] = counts[i].load(std::memory_order_relaxed);
+    total += snapshot[i];
+  }
+  if (total == 0) return 0;
+  
+  uint32_t rank = (uint32_t)(fraction * total + 0.5f);
+  if (rank < 1) rank = 1;
+  
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += snapshot[i];
+    if (seen >= rank) {
+      uint32_t bound = bucketUpperBound(i);
+      uint32_t largest = getMax();
+      return (largest > 0 && largest < bound) ? largest : bound;
+    }
+  }
+  return getMax();
+}
@@ -5,6 +5,10 @@
 #include "frame_processor.h"
 #include "task_manager.h"
 #include "performance_monitor.h"
+#include "network_impairment.h"
+#include "packet_capture.h"
+#include "trace_recorder.h"
+#include "micro_benchmark.h"
 
 void setup() {
   Serial.begin(115200);
@@ -25,23 +29,48 @@ void setup() {
     while(1) delay(1000);
   }
   
+  // Optional: without strips the decoder pushes every MCU block on its own
+  DisplayManager::getInstance().initializeStripBuffer();
+  
+  // Time the hot paths while nothing else runs, then start normally
+  if (Config::BENCHMARK_AT_BOOT && MicroBenchmark::getInstance().run()) {
+    MicroBenchmark::getInstance().printJson();
+  }
+  
   // Initialize network manager
   if (!NetworkManager::getInstance().initialize()) {
     Serial.println("FATAL: Network initialization failed!");
     while(1) delay(1000);
   }
   
-  // Initialize and start task manager
-  if (!TaskManager::getInstance().initialize()) {
-    Serial.println("FATAL: Task manager initialization failed!");
-    while(1) delay(1000);
+  // Debug only: degrade received traffic before it reaches the frame processor
+  if (Config::IMPAIRMENT_ENABLED && 
+      !NetworkImpairment::getInstance().initialize(Config::IMPAIRMENT_PROFILE, Config::IMPAIRMENT_SEED)) {
+    Serial.println("WARNING: Network impairment disabled");
+  }
+  
+  // Record received datagrams from the first one (or "capture start" later)
+  if (Config::CAPTURE_ENABLED) {
+    PacketCapture::getInstance().start();
   }
   
-  // Show ready message
+  // Time the hot spots from boot (or "trace start" later)
+  if (Config::TRACE_ENABLED) {
+    TraceRecorder::getInstance().start();
+  }
+  
+  // Show ready message, while the panel is still ours: once the tasks run,
+  // only the display task may draw
   DisplayManager::getInstance().showStartupMessage("HIGH-SPEED COMPLETE FRAME SYSTEM READY");
   delay(3000);
   DisplayManager::getInstance().clearScreen();
   
+  // Initialize and start task manager
+  if (!TaskManager::getInstance().initialize()) {
+    Serial.println("FATAL: Task manager initialization failed!");
+    while(1) delay(1000);
+  }
+  
   Serial.println("==========================================");
   Serial.println("HIGH-SPEED COMPLETE FRAME SYSTEM READY");
   Serial.println("Features:");
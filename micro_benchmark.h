@@ -0,0 +1,368 @@
+// micro_benchmark.h
+#ifndef MICRO_BENCHMARK_H
+#define MICRO_BENCHMARK_H
+
+#include "config.h"
+
+struct BenchmarkResult {
+  const char* name;
+  uint32_t iterations;
+  uint64_t cycles;        // Spent inside the timed sections
+  uint32_t bytesPerOp;
+  bool skipped;
+};
+
+// Times the receive and render hot paths on the real modules: processPacket
+// with in-order, reordered and duplicated traffic, validateCompleteJPEG,
+// assembleCompleteFrame, the decoder output callback, the strip transfer with
+// every block changed and with none, and scaling a QVGA frame to the panel.
+// Runs before the tasks start (Config::BENCHMARK_AT_BOOT) or in the host
+// runner, never next to live traffic, and re-initializes the frame processor
+// and the counters afterwards. Results are printed as one JSON object.
+class MicroBenchmark {
+private:
+  static const uint16_t PACKET_STRIDE = WireProto::MAX_HEADER_SIZE + WireProto::PAYLOAD_SIZE;
+  static const uint16_t FRAME_PACKETS =
+    (Config::BENCHMARK_FRAME_SIZE + WireProto::PAYLOAD_SIZE - 1) / WireProto::PAYLOAD_SIZE;
+  static const uint8_t MAX_RESULTS = 10;     // One per case
+  
+  enum TrafficPattern : uint8_t {
+    TRAFFIC_IN_ORDER,
+    TRAFFIC_REORDERED,    // Last packet first
+    TRAFFIC_DUPLICATED    // Every packet twice
+  };
+  
+  BenchmarkResult results[MAX_RESULTS];
+  uint8_t resultCount;
+  float cyclesPerUs;
+  uint8_t* frame;         // Synthetic JPEG of BENCHMARK_FRAME_SIZE bytes
+  uint8_t* packets;       // The frame packetized, PACKET_STRIDE apart
+  uint16_t packetSizes[FRAME_PACKETS];
+  uint32_t nextFrameId;
+  
+  MicroBenchmark() : resultCount(0), cyclesPerUs(0), frame(nullptr), packets(nullptr),
+                    nextFrameId(1) {}
+  
+  void calibrate();
+  void buildFrame();
+  uint32_t feedFrame(TrafficPattern pattern);
+  BenchmarkResult& addResult(const char* name, uint32_t bytesPerOp);
+  
+  void benchProcessPacket(const char* name, TrafficPattern pattern, uint32_t caseUs);
+  void benchValidate(uint32_t caseUs);
+  void benchAssemble(uint32_t caseUs);
+  void benchOutputCallback(uint32_t caseUs);
+  void benchStripTransfer(const char* name, bool changing, uint32_t caseUs);
+  void benchScale(const char* name, Config::ScaleMode mode, uint32_t caseUs);
+  
+public:
+  static MicroBenchmark& getInstance() {
+    static MicroBenchmark instance;
+    return instance;
+  }
+  
+  // Needs the display and frame processor initialized
+  bool run(uint32_t caseMs = Config::BENCHMARK_CASE_MS);
+  void printJson() const;
+};
+
+#endif // MICRO_BENCHMARK_H
+
+// micro_benchmark.cpp
+#include "micro_benchmark.h"
+#include "frame_processor.h"
+#include "display_manager.h"
+#include "frame_scaler.h"
+#include "performance_monitor.h"
+
+bool MicroBenchmark::run(uint32_t caseMs) {
+  frame = (uint8_t*)heap_caps_malloc(Config::BENCHMARK_FRAME_SIZE, MALLOC_CAP_8BIT);
+  packets = (uint8_t*)heap_caps_malloc(FRAME_PACKETS * PACKET_STRIDE, MALLOC_CAP_8BIT);
+  if (!frame || !packets) {
+    Serial.println("Benchmark: not enough memory");
+    if (frame) { heap_caps_free(frame); frame = nullptr; }
+    if (packets) { heap_caps_free(packets); packets = nullptr; }
+    return false;
+  }
+  
+  Serial.printf("Running benchmarks, %d ms per case...\n", caseMs);
+  resultCount = 0;
+  calibrate();
+  buildFrame();
+  
+  uint32_t caseUs = caseMs * 1000;
+  benchProcessPacket("process_packet_in_order", TRAFFIC_IN_ORDER, caseUs);
+  benchProcessPacket("process_packet_reordered", TRAFFIC_REORDERED, caseUs);
+  benchProcessPacket("process_packet_duplicated", TRAFFIC_DUPLICATED, caseUs);
+  benchValidate(caseUs);
+  benchAssemble(caseUs);
+  benchOutputCallback(caseUs);
+  benchStripTransfer("strip_flush", true, caseUs);
+  benchStripTransfer("strip_flush_unchanged", false, caseUs);
+  benchScale("scale_qvga_nearest", Config::SCALE_NEAREST, caseUs);
+  benchScale("scale_qvga_bilinear", Config::SCALE_BILINEAR, caseUs);
+  
+  heap_caps_free(frame);
+  heap_caps_free(packets);
+  frame = nullptr;
+  packets = nullptr;
+  
+  // Hand the real traffic a clean frame processor: frame ids restart at the camera
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  fp.cleanup();
+  bool ready = fp.initialize();
+  PerformanceMonitor::getInstance().reset();
+  return ready;
+}
+
+void MicroBenchmark::calibrate() {
+  uint32_t startUs = micros();
+  uint32_t startCycles = ESP.getCycleCount();
+  while (micros() - startUs < 20000) {}
+  uint32_t cycles = ESP.getCycleCount() - startCycles;
+  cyclesPerUs = (float)cycles / (micros() - startUs);
+}
+
+void MicroBenchmark::buildFrame() {
+  // SOI, filler that never forms a marker, EOI
+  uint32_t state = 0x2545F491;
+  for (uint32_t i = 0; i < Config::BENCHMARK_FRAME_SIZE; i++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    frame[i] = state & 0x7F;
+  }
+  frame[0] = 0xFF;
+  frame[1] = 0xD8;
+  frame[Config::BENCHMARK_FRAME_SIZE - 2] = 0xFF;
+  frame[Config::BENCHMARK_FRAME_SIZE - 1] = 0xD9;
+  
+  WireProto::PacketHeader header;
+  header.flags = 0;
+  header.frameId = 0;
+  header.frameLength = Config::BENCHMARK_FRAME_SIZE;
+  header.totalPackets = FRAME_PACKETS;
+  header.captureTimeUs = 0;
+  for (uint16_t i = 0; i < FRAME_PACKETS; i++) {
+    uint8_t* packet = packets + i * PACKET_STRIDE;
+    header.packetIndex = i;
+    header.byteOffset = (uint32_t)i * WireProto::PAYLOAD_SIZE;
+    header.payloadLength = min((uint32_t)WireProto::PAYLOAD_SIZE, Config::BENCHMARK_FRAME_SIZE - header.byteOffset);
+    int headerSize = WireProto::writeHeader(packet, header, WireProto::VERSION);
+    memcpy(packet + headerSize, frame + header.byteOffset, header.payloadLength);
+    packetSizes[i] = headerSize + header.payloadLength;
+  }
+}
+
+// Sends one frame through processPacket under a new frame id, returns the cycles spent there
+uint32_t MicroBenchmark::feedFrame(TrafficPattern pattern) {
+  uint32_t frameId = nextFrameId++;
+  for (uint16_t i = 0; i < FRAME_PACKETS; i++) {
+    WireProto::store32(packets + i * PACKET_STRIDE + 8, frameId);
+  }
+  
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  uint32_t start = ESP.getCycleCount();
+  for (uint16_t n = 0; n < FRAME_PACKETS; n++) {
+    uint16_t i = pattern == TRAFFIC_REORDERED ? FRAME_PACKETS - 1 - n : n;
+    uint8_t* packet = packets + i * PACKET_STRIDE;
+    fp.processPacket(packet, packetSizes[i]);
+    if (pattern == TRAFFIC_DUPLICATED) fp.processPacket(packet, packetSizes[i]);
+  }
+  return ESP.getCycleCount() - start;
+}
+
+BenchmarkResult& MicroBenchmark::addResult(const char* name, uint32_t bytesPerOp) {
+  BenchmarkResult& result = results[resultCount++];
+  result.name = name;
+  result.iterations = 0;
+  result.cycles = 0;
+  result.bytesPerOp = bytesPerOp;
+  result.skipped = false;
+  return result;
+}
+
+void MicroBenchmark::benchProcessPacket(const char* name, TrafficPattern pattern, uint32_t caseUs) {
+  uint16_t callsPerFrame = pattern == TRAFFIC_DUPLICATED ? 2 * FRAME_PACKETS : FRAME_PACKETS;
+  BenchmarkResult& result = addResult(name, Config::BENCHMARK_FRAME_SIZE / callsPerFrame);
+  
+  uint32_t start = micros();
+  while (micros() - start < caseUs) {
+    result.cycles += feedFrame(pattern);
+    result.iterations += callsPerFrame;
+  }
+}
+
+void MicroBenchmark::benchValidate(uint32_t caseUs) {
+  BenchmarkResult& result = addResult("validate_complete_jpeg", Config::BENCHMARK_FRAME_SIZE);
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  
+  // Batches, so the timer reads do not dominate a few-byte scan
+  uint32_t start = micros();
+  while (micros() - start < caseUs) {
+    uint32_t batchStart = ESP.getCycleCount();
+    for (uint8_t i = 0; i < 64; i++) {
+      if (!fp.validateCompleteJPEG(frame, Config::BENCHMARK_FRAME_SIZE)) return;
+    }
+    result.cycles += ESP.getCycleCount() - batchStart;
+    result.iterations += 64;
+  }
+}
+
+void MicroBenchmark::benchAssemble(uint32_t caseUs) {
+  BenchmarkResult& result = addResult("assemble_complete_frame", Config::BENCHMARK_FRAME_SIZE);
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  
+  uint32_t start = micros();
+  while (micros() - start < caseUs) {
+    feedFrame(TRAFFIC_IN_ORDER);
+    
+    uint32_t assembleStart = ESP.getCycleCount();
+    bool assembled = fp.assembleCompleteFrame();
+    result.cycles += ESP.getCycleCount() - assembleStart;
+    fp.resetCurrentFrame();
+    
+    if (!assembled) return;
+    result.iterations++;
+  }
+}
+
+void MicroBenchmark::benchOutputCallback(uint32_t caseUs) {
+  DisplayManager& dm = DisplayManager::getInstance();
+  const uint8_t blockSize = 16;
+  BenchmarkResult& result = addResult(dm.isStripBufferEnabled() ? "tft_output_strip" : "tft_output_direct",
+                                      blockSize * blockSize * 2);
+  
+  // One MCU block at a time, in the decoder's raster order, a new frame each
+  // time the display is covered; the strip flush at the end of each MCU row
+  // is part of the cost, and the block changes every row so delta updates
+  // send it all
+  static uint16_t block[blockSize * blockSize];
+  for (uint16_t i = 0; i < blockSize * blockSize; i++) block[i] = i * 0x0841;
+  dm.beginStrips(0, Config::DISPLAY_WIDTH);
+  
+  int16_t x = 0;
+  int16_t y = 0;
+  uint32_t start = micros();
+  while (micros() - start < caseUs) {
+    uint32_t blockStart = ESP.getCycleCount();
+    highSpeedTftOutput(x, y, blockSize, blockSize, block);
+    result.cycles += ESP.getCycleCount() - blockStart;
+    result.iterations++;
+    
+    x += blockSize;
+    if (x >= Config::DISPLAY_WIDTH) {
+      x = 0;
+      y = (y + blockSize) % Config::DISPLAY_HEIGHT;
+      block[0]++;
+      if (y == 0) {
+        dm.endStrips();
+        dm.beginStrips(0, Config::DISPLAY_WIDTH);
+      }
+    }
+  }
+  dm.endStrips();
+}
+
+// Changing, every block of the strip differs from the previous flush and is
+// sent; unchanged, the flush is the signature check alone when delta updates
+// are on
+void MicroBenchmark::benchStripTransfer(const char* name, bool changing, uint32_t caseUs) {
+  DisplayManager& dm = DisplayManager::getInstance();
+  BenchmarkResult& result = addResult(name, Config::STRIP_BUFFER_SIZE);
+  if (!dm.isStripBufferEnabled()) {
+    result.skipped = true;
+    return;
+  }
+  
+  // With DMA each flush also waits for the previous strip, which the
+  // untimed fill may not have covered. Strips go down the display a frame
+  // at a time, so each is compared with the same strip of the last frame.
+  static uint16_t block[Config::STRIP_ROWS * Config::STRIP_ROWS];
+  dm.beginStrips(0, Config::DISPLAY_WIDTH);
+  
+  int16_t y = 0;
+  uint32_t start = micros();
+  while (micros() - start < caseUs) {
+    // Fill one full MCU row untimed, then time its transfer alone
+    if (changing) block[0]++;
+    for (int16_t x = 0; x < Config::DISPLAY_WIDTH; x += Config::STRIP_ROWS) {
+      dm.addToStrip(x, y, Config::STRIP_ROWS, Config::STRIP_ROWS, Config::STRIP_ROWS, block);
+    }
+    
+    uint32_t transferStart = ESP.getCycleCount();
+    dm.flushStrip();
+    result.cycles += ESP.getCycleCount() - transferStart;
+    result.iterations++;
+    
+    y += Config::STRIP_ROWS;
+    if (y + Config::STRIP_ROWS > Config::DISPLAY_HEIGHT) {
+      y = 0;
+      dm.endStrips();
+      dm.beginStrips(0, Config::DISPLAY_WIDTH);
+    }
+  }
+  dm.endStrips();
+}
+
+// One op is a whole 320x240 frame scaled to what SCALE_KEEP_ASPECT makes of
+// the panel, fed a strip of source rows at a time as the decoder would; the
+// output rows are overwritten in place and never sent
+void MicroBenchmark::benchScale(const char* name, Config::ScaleMode mode, uint32_t caseUs) {
+  const uint16_t sourceWidth = 320;
+  const uint16_t sourceHeight = 240;
+  uint16_t outWidth, outHeight;
+  FrameScaler::fitSize(sourceWidth, sourceHeight, Config::DISPLAY_WIDTH, Config::DISPLAY_HEIGHT, 
+                       Config::SCALE_KEEP_ASPECT, outWidth, outHeight);
+  BenchmarkResult& result = addResult(name, outWidth * outHeight * 2);
+  
+  FrameScaler scaler;
+  uint16_t* source = (uint16_t*)heap_caps_malloc(sourceWidth * Config::STRIP_ROWS * 2, MALLOC_CAP_8BIT);
+  uint16_t* output = (uint16_t*)heap_caps_malloc(Config::STRIP_BUFFER_SIZE, MALLOC_CAP_8BIT);
+  if (!source || !output || !scaler.initialize() || 
+      !scaler.configure(mode, sourceWidth, sourceHeight, outWidth, outHeight)) {
+    result.skipped = true;
+  } else {
+    for (uint32_t i = 0; i < sourceWidth * Config::STRIP_ROWS; i++) source[i] = i * 0x0841;
+    
+    uint32_t start = micros();
+    while (micros() - start < caseUs) {
+      uint32_t frameStart = ESP.getCycleCount();
+      scaler.beginFrame();
+      for (uint16_t row = 0; row < sourceHeight; row += Config::STRIP_ROWS) {
+        while (scaler.scaleRows(source, row, Config::STRIP_ROWS, output, Config::STRIP_ROWS) == Config::STRIP_ROWS) {}
+      }
+      result.cycles += ESP.getCycleCount() - frameStart;
+      
+      if (scaler.getRowsDone() != outHeight) {
+        result.skipped = true;
+        break;
+      }
+      result.iterations++;
+    }
+  }
+  
+  if (source) heap_caps_free(source);
+  if (output) heap_caps_free(output);
+}
+
+void MicroBenchmark::printJson() const {
+  Serial.printf("{\"chip\":\"%s\",\"cycles_per_us\":%.1f,\"frame_bytes\":%d,\"results\":[\n",
+               ESP.getChipModel(), cyclesPerUs, Config::BENCHMARK_FRAME_SIZE);
+  for (uint8_t i = 0; i < resultCount; i++) {
+    const BenchmarkResult& result = results[i];
+    const char* separator = i + 1 < resultCount ? "," : "";
+    
+    if (result.skipped || result.iterations == 0) {
+      Serial.printf("  {\"name\":\"%s\",\"skipped\":true}%s\n", result.name, separator);
+      continue;
+    }
+    
+    double cyclesPerOp = (double)result.cycles / result.iterations;
+    double nsPerOp = cyclesPerOp * 1000.0 / cyclesPerUs;
+    double bytesPerSecond = nsPerOp > 0 ? result.bytesPerOp * 1e9 / nsPerOp : 0;
+    Serial.printf("  {\"name\":\"%s\",\"iterations\":%d,\"ns_per_op\":%.1f,\"bytes_per_s\":%.0f,\"cycles_per_op\":%.1f}%s\n",
+                 result.name, result.iterations, nsPerOp, bytesPerSecond, cyclesPerOp, separator);
+  }
+  Serial.println("]}");
+}
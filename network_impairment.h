@@ -0,0 +1,233 @@
+// network_impairment.h
+#ifndef NETWORK_IMPAIRMENT_H
+#define NETWORK_IMPAIRMENT_H
+
+#include "config.h"
+
+// Debug stage between the socket and FrameProcessor::processPacket: drops,
+// delays, reorders, duplicates and truncates datagrams from a seeded PRNG, so
+// the same seed and the same input give the same impaired stream.
+class NetworkImpairment {
+private:
+  struct HeldPacket {
+    uint8_t* data;
+    uint16_t size;
+    uint32_t releaseTime;   // micros()
+    uint32_t sequence;      // Submission order, breaks releaseTime ties
+    bool inUse;
+  };
+  
+  static const uint16_t MAX_DATAGRAM_SIZE = WireProto::MAX_HEADER_SIZE + WireProto::PARITY_PAYLOAD_SIZE;
+  
+  Config::ImpairmentProfile profile;
+  HeldPacket held[Config::IMPAIRMENT_QUEUE_DEPTH];
+  uint8_t* storage;
+  uint32_t rngState;
+  uint32_t nextSequence;
+  uint8_t heldCount;
+  bool burstState;          // Gilbert-Elliott bad state
+  bool active;
+  
+  // Statistics
+  uint32_t packetsSubmitted;
+  uint32_t packetsDelivered;
+  uint32_t packetsDropped;
+  uint32_t packetsBurstDropped;
+  uint32_t packetsReordered;
+  uint32_t packetsDuplicated;
+  uint32_t packetsTruncated;
+  uint32_t queueOverflows;
+  
+  NetworkImpairment();
+  
+  uint32_t nextRandom();
+  float nextUniform();
+  void hold(const uint8_t* data, uint16_t size, uint32_t releaseTime);
+  
+public:
+  static NetworkImpairment& getInstance() {
+    static NetworkImpairment instance;
+    return instance;
+  }
+  
+  bool initialize(const Config::ImpairmentProfile& profile, uint32_t seed);
+  void cleanup();
+  bool isActive() const { return active; }
+  
+  // Impairs one received datagram; whatever survives is held until its release time
+  void submit(const uint8_t* data, int size, uint32_t now);
+  
+  // Copies out the next datagram due at 'now'. Returns its size, 0 if none is due.
+  int release(uint8_t* buffer, int maxSize, uint32_t now);
+  bool hasPending() const { return heldCount > 0; }
+  
+  // Getters
+  uint32_t getSubmittedPackets() const { return packetsSubmitted; }
+  uint32_t getDeliveredPackets() const { return packetsDelivered; }
+  uint32_t getDroppedPackets() const { return packetsDropped + packetsBurstDropped; }
+  uint32_t getReorderedPackets() const { return packetsReordered; }
+  uint32_t getDuplicatedPackets() const { return packetsDuplicated; }
+  uint32_t getTruncatedPackets() const { return packetsTruncated; }
+  
+  void printStatistics() const;
+};
+
+#endif // NETWORK_IMPAIRMENT_H
+
+// network_impairment.cpp
+#include "network_impairment.h"
+
+NetworkImpairment::NetworkImpairment() : storage(nullptr), rngState(1), nextSequence(0),
+                                         heldCount(0), burstState(false), active(false),
+                                         packetsSubmitted(0), packetsDelivered(0),
+                                         packetsDropped(0), packetsBurstDropped(0),
+                                         packetsReordered(0), packetsDuplicated(0),
+                                         packetsTruncated(0), queueOverflows(0) {
+  memset(&profile, 0, sizeof(profile));
+  memset(held, 0, sizeof(held));
+}
+
+bool NetworkImpairment::initialize(const Config::ImpairmentProfile& newProfile, uint32_t seed) {
+  cleanup();
+  
+  storage = (uint8_t*)heap_caps_malloc(Config::IMPAIRMENT_QUEUE_DEPTH * MAX_DATAGRAM_SIZE, MALLOC_CAP_8BIT);
+  if (!storage) {
+    Serial.println("Failed to allocate impairment queue");
+    return false;
+  }
+  
+  for (int i = 0; i < Config::IMPAIRMENT_QUEUE_DEPTH; i++) {
+    held[i].data = storage + i * MAX_DATAGRAM_SIZE;
+    held[i].inUse = false;
+  }
+  
+  profile = newProfile;
+  rngState = seed ? seed : 1;  // xorshift32 must not start at 0
+  nextSequence = 0;
+  heldCount = 0;
+  burstState = false;
+  active = true;
+  
+  Serial.printf("Network impairment '%s' active, seed %u\n", profile.name, seed);
+  return true;
+}
+
+void NetworkImpairment::cleanup() {
+  if (storage) {
+    heap_caps_free(storage);
+    storage = nullptr;
+  }
+  memset(held, 0, sizeof(held));
+  heldCount = 0;
+  active = false;
+}
+
+uint32_t NetworkImpairment::nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+float NetworkImpairment::nextUniform() {
+  return (nextRandom() >> 8) / 16777216.0f;
+}
+
+void NetworkImpairment::submit(const uint8_t* data, int size, uint32_t now) {
+  if (!active || size <= 0 || size > MAX_DATAGRAM_SIZE) return;
+  packetsSubmitted++;
+  
+  // Every packet draws the same numbers in the same order, so changing one
+  // rate leaves the other decisions of a seed unchanged
+  float stateDraw = nextUniform();
+  float burstLossDraw = nextUniform();
+  float lossDraw = nextUniform();
+  float truncateDraw = nextUniform();
+  uint32_t truncateLength = nextRandom();
+  float reorderDraw = nextUniform();
+  uint32_t jitterDraw = nextRandom();
+  float duplicateDraw = nextUniform();
+  uint32_t duplicateJitterDraw = nextRandom();
+  
+  if (burstState) {
+    if (stateDraw < profile.burstExitRate) burstState = false;
+  } else if (stateDraw < profile.burstEnterRate) {
+    burstState = true;
+  }
+  
+  if (burstState && burstLossDraw < profile.burstLossRate) {
+    packetsBurstDropped++;
+    return;
+  }
+  
+  if (lossDraw < profile.lossRate) {
+    packetsDropped++;
+    return;
+  }
+  
+  uint16_t length = size;
+  if (size > 1 && truncateDraw < profile.truncateRate) {
+    length = 1 + truncateLength % (size - 1);
+    packetsTruncated++;
+  }
+  
+  uint32_t delay = profile.jitterUs ? jitterDraw % (profile.jitterUs + 1) : 0;
+  if (reorderDraw < profile.reorderRate) {
+    delay += profile.reorderDelayUs;
+    packetsReordered++;
+  }
+  hold(data, length, now + delay);
+  
+  if (duplicateDraw < profile.duplicateRate) {
+    uint32_t extra = profile.jitterUs ? duplicateJitterDraw % (profile.jitterUs + 1) : 0;
+    hold(data, length, now + delay + extra);
+    packetsDuplicated++;
+  }
+}
+
+void NetworkImpairment::hold(const uint8_t* data, uint16_t size, uint32_t releaseTime) {
+  for (int i = 0; i < Config::IMPAIRMENT_QUEUE_DEPTH; i++) {
+    HeldPacket& packet = held[i];
+    if (packet.inUse) continue;
+    
+    memcpy(packet.data, data, size);
+    packet.size = size;
+    packet.releaseTime = releaseTime;
+    packet.sequence = nextSequence++;
+    packet.inUse = true;
+    heldCount++;
+    return;
+  }
+  
+  // Queue full: the datagram is lost, as in an overflowing socket buffer
+  queueOverflows++;
+}
+
+int NetworkImpairment::release(uint8_t* buffer, int maxSize, uint32_t now) {
+  HeldPacket* next = nullptr;
+  for (int i = 0; i < Config::IMPAIRMENT_QUEUE_DEPTH; i++) {
+    HeldPacket& packet = held[i];
+    if (!packet.inUse || (int32_t)(now - packet.releaseTime) < 0) continue;
+    
+    if (!next || (int32_t)(packet.releaseTime - next->releaseTime) < 0 ||
+        (packet.releaseTime == next->releaseTime && (int32_t)(packet.sequence - next->sequence) < 0)) {
+      next = &packet;
+    }
+  }
+  if (!next) return 0;
+  
+  int size = min((int)next->size, maxSize);
+  memcpy(buffer, next->data, size);
+  next->inUse = false;
+  heldCount--;
+  packetsDelivered++;
+  return size;
+}
+
+void NetworkImpairment::printStatistics() const {
+  if (!active) return;
+  
+  Serial.printf("Impairment '%s': In=%d, Out=%d, Dropped=%d (burst %d), Reordered=%d, Duplicated=%d, Truncated=%d, Overflow=%d\n",
+               profile.name, packetsSubmitted, packetsDelivered, packetsDropped + packetsBurstDropped,
+               packetsBurstDropped, packetsReordered, packetsDuplicated, packetsTruncated, queueOverflows);
+}
@@ -3,13 +3,20 @@
 #define NETWORK_MANAGER_H
 
 #include "config.h"
+#include <lwip/sockets.h>
 
 class NetworkManager {
 private:
-  WiFiUDP udp;
+  int udpSocket;
   int connectedClients;
   
-  NetworkManager() : connectedClients(0) {}
+  // Source of the last accepted frame packet, where retransmit requests go
+  struct sockaddr_in cameraAddress;
+  bool cameraKnown;
+  
+  NetworkManager() : udpSocket(-1), connectedClients(0), cameraKnown(false) {}
+  
+  bool openUdpSocket();
   
   static void wifiEventHandler(WiFiEvent_t event);
   
@@ -20,7 +27,7 @@ public:
   }
   
   bool initialize();
-  WiFiUDP& getUDP() { return udp; }
+  int getSocket() const { return udpSocket; }
   int getConnectedClients() const { return connectedClients; }
   void incrementClients() { connectedClients++; }
   void decrementClients() { 
@@ -31,12 +38,27 @@ public:
   // Packet processing
   bool hasPacket();
   int readPacket(uint8_t* buffer, int maxSize);
+  
+  // Zero-copy receive: peek the header (blocking up to the socket timeout when
+  // 'wait' is set), then receive header and payload in one scatter read. The
+  // peek returns -1 when nothing is queued and 0 for an empty datagram, which
+  // the caller must still consume.
+  int peekPacketHeader(uint8_t* header, int headerSize, bool wait);
+  int receivePacket(uint8_t* header, int headerSize, uint8_t* payload, int payloadSize);
+  void skipPacket();
+  
+  // Back channel to the camera (retransmit requests)
+  bool sendToCamera(const uint8_t* data, int size);
+  
+  // Telemetry reports to Config::TELEMETRY_ADDRESS
+  bool sendTelemetry(const uint8_t* data, int size);
 };
 
 #endif // NETWORK_MANAGER_H
 
 // network_manager.cpp
 #include "network_manager.h"
+#include "packet_capture.h"
 
 bool NetworkManager::initialize() {
   Serial.println("Setting up WiFi Access Point...");
@@ -58,7 +80,7 @@ bool NetworkManager::initialize() {
   Serial.printf("WiFi AP: %s (%s)\n", Config::AP_SSID, WiFi.softAPIP().toString().c_str());
   
   // Start UDP server
-  if (!udp.begin(Config::UDP_PORT)) {
+  if (!openUdpSocket()) {
     Serial.println("FATAL: Failed to start UDP server");
     return false;
   }
@@ -67,6 +89,35 @@ bool NetworkManager::initialize() {
   return true;
 }
 
+bool NetworkManager::openUdpSocket() {
+  udpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (udpSocket < 0) return false;
+  
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(Config::UDP_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  
+  if (bind(udpSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(udpSocket);
+    udpSocket = -1;
+    return false;
+  }
+  
+  // Blocking reads wake up at least this often so frame timeouts are still checked
+  struct timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = Config::FRAME_TIMEOUT_CHECK_INTERVAL * 1000;
+  setsockopt(udpSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  
+  // Telemetry may go to the AP broadcast address
+  int broadcast = 1;
+  setsockopt(udpSocket, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+  
+  return true;
+}
+
 void NetworkManager::wifiEventHandler(WiFiEvent_t event) {
   NetworkManager& nm = NetworkManager::getInstance();
   
@@ -85,13 +136,91 @@ void NetworkManager::wifiEventHandler(WiFiEvent_t event) {
 }
 
 bool NetworkManager::hasPacket() {
-  return udp.parsePacket() > 0;
+  uint8_t probe;
+  return recv(udpSocket, &probe, sizeof(probe), MSG_PEEK | MSG_DONTWAIT) >= 0;
 }
 
 int NetworkManager::readPacket(uint8_t* buffer, int maxSize) {
-  int packetSize = udp.parsePacket();
-  if (packetSize > 0 && packetSize <= maxSize) {
-    return udp.read(buffer, packetSize);
+  struct sockaddr_in source;
+  socklen_t sourceLength = sizeof(source);
+  int packetSize = recvfrom(udpSocket, buffer, maxSize, MSG_DONTWAIT, 
+                            (struct sockaddr*)&source, &sourceLength);
+  if (packetSize <= 0) return 0;
+  
+  cameraAddress = source;
+  cameraKnown = true;
+  PacketCapture::getInstance().record(buffer, packetSize);
+  return packetSize;
+}
+
+int NetworkManager::peekPacketHeader(uint8_t* header, int headerSize, bool wait) {
+  int flags = MSG_PEEK | (wait ? 0 : MSG_DONTWAIT);
+  int bytesPeeked = recv(udpSocket, header, headerSize, flags);
+  return bytesPeeked >= 0 ? bytesPeeked : -1;
+}
+
+int NetworkManager::receivePacket(uint8_t* header, int headerSize, uint8_t* payload, int payloadSize) {
+  // A few spare bytes catch datagrams longer than the header announced
+  uint8_t overflow[4];
+  struct iovec iov[3];
+  iov[0].iov_base = header;
+  iov[0].iov_len = headerSize;
+  iov[1].iov_base = payload;
+  iov[1].iov_len = payloadSize;
+  iov[2].iov_base = overflow;
+  iov[2].iov_len = sizeof(overflow);
+  
+  struct sockaddr_in source;
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = &source;
+  msg.msg_namelen = sizeof(source);
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 3;
+  
+  int bytesReceived = recvmsg(udpSocket, &msg, MSG_DONTWAIT);
+  if (bytesReceived <= 0) return 0;
+  
+  cameraAddress = source;
+  cameraKnown = true;
+  PacketCapture::getInstance().record(header, min(bytesReceived, headerSize), 
+                                      payload, min(bytesReceived - headerSize, payloadSize));
+  return bytesReceived;
+}
+
+bool NetworkManager::sendToCamera(const uint8_t* data, int size) {
+  if (!cameraKnown) return false;
+  
+  int bytesSent = sendto(udpSocket, data, size, MSG_DONTWAIT, 
+                         (struct sockaddr*)&cameraAddress, sizeof(cameraAddress));
+  return bytesSent == size;
+}
+
+bool NetworkManager::sendTelemetry(const uint8_t* data, int size) {
+  if (udpSocket < 0) return false;
+  
+  struct sockaddr_in collector;
+  memset(&collector, 0, sizeof(collector));
+  collector.sin_family = AF_INET;
+  collector.sin_port = htons(Config::TELEMETRY_PORT);
+  collector.sin_addr.s_addr = (uint32_t)Config::TELEMETRY_ADDRESS;
+  
+  int bytesSent = sendto(udpSocket, data, size, MSG_DONTWAIT, 
+                         (struct sockaddr*)&collector, sizeof(collector));
+  return bytesSent == size;
+}
+
+void NetworkManager::skipPacket() {
+  // Rejected datagrams are part of what a replay has to reproduce
+  PacketCapture& capture = PacketCapture::getInstance();
+  if (capture.isActive()) {
+    static uint8_t datagram[CaptureFormat::MAX_DATAGRAM_SIZE];
+    int size = recv(udpSocket, datagram, sizeof(datagram), MSG_DONTWAIT);
+    if (size > 0) capture.record(datagram, size);
+    return;
   }
-  return 0;
+  
+  // Datagram sockets drop whatever a read leaves behind
+  uint8_t discard;
+  recv(udpSocket, &discard, sizeof(discard), MSG_DONTWAIT);
 }
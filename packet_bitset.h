@@ -0,0 +1,67 @@
+// packet_bitset.h
+#ifndef PACKET_BITSET_H
+#define PACKET_BITSET_H
+
+#include "config.h"
+
+// Fixed-size packet arrival bitmap: one bit per packet index, reset and
+// queried a 32-bit word at a time.
+struct PacketBitset {
+  static const uint16_t CAPACITY = Config::PACKET_BITSET_WORDS * 32;
+  
+  uint32_t words[Config::PACKET_BITSET_WORDS];
+  
+  void clear() { memset(words, 0, sizeof(words)); }
+  
+  void set(uint16_t index) { words[index >> 5] |= (uint32_t)1 << (index & 31); }
+  
+  bool test(uint16_t index) const { return (words[index >> 5] >> (index & 31)) & 1; }
+  
+  // Number of packets received among indices [0, packetCount)
+  uint16_t count(uint16_t packetCount) const {
+    uint16_t total = 0;
+    uint16_t fullWords = packetCount >> 5;
+    for (uint16_t w = 0; w < fullWords; w++) {
+      total += __builtin_popcount(words[w]);
+    }
+    if (packetCount & 31) {
+      total += __builtin_popcount(words[fullWords] & tailMask(packetCount));
+    }
+    return total;
+  }
+  
+  // True when every index in [0, packetCount) has been received
+  bool isComplete(uint16_t packetCount) const {
+    uint16_t fullWords = packetCount >> 5;
+    for (uint16_t w = 0; w < fullWords; w++) {
+      if (words[w] != 0xFFFFFFFFUL) return false;
+    }
+    if (packetCount & 31) {
+      uint32_t mask = tailMask(packetCount);
+      return (words[fullWords] & mask) == mask;
+    }
+    return true;
+  }
+  
+  // Lowest missing index at or after 'from', or -1 if [from, packetCount) is complete
+  int firstMissing(uint16_t packetCount, uint16_t from = 0) const {
+    if (from >= packetCount) return -1;
+    
+    uint16_t word = from >> 5;
+    uint16_t lastWord = (packetCount - 1) >> 5;
+    uint32_t missing = ~words[word] & (0xFFFFFFFFUL << (from & 31));
+    
+    while (!missing) {
+      if (++word > lastWord) return -1;
+      missing = ~words[word];
+    }
+    
+    int index = (word << 5) + __builtin_ctz(missing);
+    return index < packetCount ? index : -1;
+  }
+  
+private:
+  static uint32_t tailMask(uint16_t packetCount) { return ((uint32_t)1 << (packetCount & 31)) - 1; }
+};
+
+#endif // PACKET_BITSET_H
@@ -0,0 +1,277 @@
+// packet_capture.h
+#ifndef PACKET_CAPTURE_H
+#define PACKET_CAPTURE_H
+
+#include "config.h"
+
+// Capture layout, little-endian like the wire protocol:
+//   file header (16 bytes): magic u32 "WCAP", version u16, header_size u16,
+//                           snap_length u16 (0 = whole datagrams), reserved u16 + u32
+//   record (8 + captured):  time_us u32, captured_length u16, original_length u16, bytes
+// Records are in receive order, as returned by the socket.
+namespace CaptureFormat {
+  constexpr uint32_t MAGIC = 0x50414357;    // "WCAP"
+  constexpr uint16_t VERSION = 1;
+  constexpr uint8_t FILE_HEADER_SIZE = 16;
+  constexpr uint8_t RECORD_HEADER_SIZE = 8;
+  constexpr uint16_t MAX_DATAGRAM_SIZE = WireProto::MAX_HEADER_SIZE + WireProto::PARITY_PAYLOAD_SIZE;
+  
+  inline void writeFileHeader(uint8_t* out, uint16_t snapLength) {
+    memset(out, 0, FILE_HEADER_SIZE);
+    WireProto::store32(out, MAGIC);
+    WireProto::store16(out + 4, VERSION);
+    WireProto::store16(out + 6, FILE_HEADER_SIZE);
+    WireProto::store16(out + 8, snapLength);
+  }
+}
+
+// Records every datagram the network manager hands out. On the device the
+// newest records are kept in a RAM ring (snapped to CAPTURE_SNAP_LENGTH) and
+// dumped as hex on the serial console; the host build writes whole datagrams
+// to Config::CAPTURE_FILE.
+class PacketCapture {
+private:
+  SemaphoreHandle_t captureMutex;   // Writer never waits on it, the dump does
+  volatile bool active;
+  
+  // Device ring: records between ringHead (oldest) and ringTail, contiguous;
+  // the unused end of the buffer before a wrap is padding
+  uint8_t* ring;
+  uint32_t ringHead;
+  uint32_t ringTail;
+  uint32_t ringUsed;
+  uint32_t ringRecords;
+  FILE* file;
+  
+  // Statistics
+  uint32_t recordsCaptured;
+  uint32_t recordsOverwritten;
+  uint32_t recordsDropped;
+  
+  PacketCapture();
+  
+  void appendToRing(const uint8_t* recordHeader, const uint8_t* first, int firstSize,
+                    const uint8_t* second, int secondSize);
+  void evictOldest();
+  bool isPadding(uint32_t offset) const;
+  
+public:
+  static PacketCapture& getInstance() {
+    static PacketCapture instance;
+    return instance;
+  }
+  
+  bool start();
+  void stop();
+  bool isActive() const { return active; }
+  
+  // A datagram may arrive in two pieces (zero-copy header + payload)
+  void record(const uint8_t* first, int firstSize, const uint8_t* second = nullptr, int secondSize = 0);
+  
+  // Writes the ring as a hex capture between CAPTURE BEGIN / CAPTURE END lines
+  void dump();
+  void printStatus() const;
+};
+
+#endif // PACKET_CAPTURE_H
+
+// packet_capture.cpp
+#include "packet_capture.h"
+
+static const uint16_t RING_PADDING = 0xFFFF;
+
+PacketCapture::PacketCapture() : captureMutex(nullptr), active(false), ring(nullptr),
+                                 ringHead(0), ringTail(0), ringUsed(0), ringRecords(0),
+                                 file(nullptr), recordsCaptured(0), recordsOverwritten(0),
+                                 recordsDropped(0) {}
+
+bool PacketCapture::start() {
+  if (active) return true;
+  
+  if (!captureMutex) {
+    captureMutex = xSemaphoreCreateMutex();
+    if (!captureMutex) return false;
+  }
+  
+  xSemaphoreTake(captureMutex, portMAX_DELAY);
+
+#ifdef HOST_BUILD
+  file = fopen(Config::CAPTURE_FILE, "wb");
+  if (file) {
+    uint8_t header[CaptureFormat::FILE_HEADER_SIZE];
+    CaptureFormat::writeFileHeader(header, 0);
+    fwrite(header, 1, sizeof(header), file);
+  }
+  bool ready = file != nullptr;
+#else
+  if (!ring) {
+    ring = (uint8_t*)heap_caps_malloc(Config::CAPTURE_BUFFER_SIZE, MALLOC_CAP_8BIT);
+  }
+  bool ready = ring != nullptr;
+#endif
+  
+  ringHead = ringTail = ringUsed = ringRecords = 0;
+  recordsCaptured = recordsOverwritten = recordsDropped = 0;
+  active = ready;
+  xSemaphoreGive(captureMutex);
+  
+  if (!ready) {
+    Serial.println("Packet capture: no buffer");
+    return false;
+  }
+  
+  Serial.printf("Packet capture started (%s)\n", file ? Config::CAPTURE_FILE : "RAM ring");
+  return true;
+}
+
+void PacketCapture::stop() {
+  if (!active) return;
+  
+  xSemaphoreTake(captureMutex, portMAX_DELAY);
+  active = false;
+  if (file) {
+    fclose(file);
+    file = nullptr;
+  }
+  xSemaphoreGive(captureMutex);
+  
+  Serial.printf("Packet capture stopped: %d records\n", recordsCaptured);
+}
+
+void PacketCapture::record(const uint8_t* first, int firstSize, const uint8_t* second, int secondSize) {
+  if (!active || firstSize <= 0) return;
+  
+  // Never stall the UDP task behind a dump
+  if (xSemaphoreTake(captureMutex, 0) != pdTRUE) {
+    recordsDropped++;
+    return;
+  }
+  
+  if (!active) {
+    xSemaphoreGive(captureMutex);
+    return;
+  }
+  
+  if (secondSize < 0) secondSize = 0;
+  uint16_t originalLength = min(firstSize + secondSize, (int)CaptureFormat::MAX_DATAGRAM_SIZE);
+  uint8_t recordHeader[CaptureFormat::RECORD_HEADER_SIZE];
+  WireProto::store32(recordHeader, micros());
+  WireProto::store16(recordHeader + 6, originalLength);
+  
+  if (file) {
+    WireProto::store16(recordHeader + 4, originalLength);
+    fwrite(recordHeader, 1, sizeof(recordHeader), file);
+    fwrite(first, 1, min(firstSize, (int)originalLength), file);
+    if (originalLength > firstSize) fwrite(second, 1, originalLength - firstSize, file);
+  } else {
+    appendToRing(recordHeader, first, firstSize, second, secondSize);
+  }
+  recordsCaptured++;
+  
+  xSemaphoreGive(captureMutex);
+}
+
+bool PacketCapture::isPadding(uint32_t offset) const {
+  return Config::CAPTURE_BUFFER_SIZE - offset < CaptureFormat::RECORD_HEADER_SIZE ||
+         WireProto::load16(ring + offset + 4) == RING_PADDING;
+}
+
+void PacketCapture::evictOldest() {
+  if (isPadding(ringHead)) {
+    ringUsed -= Config::CAPTURE_BUFFER_SIZE - ringHead;
+    ringHead = 0;
+    return;
+  }
+  
+  uint32_t size = CaptureFormat::RECORD_HEADER_SIZE + WireProto::load16(ring + ringHead + 4);
+  ringHead += size;
+  ringUsed -= size;
+  ringRecords--;
+  recordsOverwritten++;
+}
+
+void PacketCapture::appendToRing(const uint8_t* recordHeader, const uint8_t* first, int firstSize,
+                                 const uint8_t* second, int secondSize) {
+  uint16_t length = WireProto::load16(recordHeader + 6);
+  if (Config::CAPTURE_SNAP_LENGTH > 0) length = min(length, Config::CAPTURE_SNAP_LENGTH);
+  uint32_t size = CaptureFormat::RECORD_HEADER_SIZE + length;
+  
+  // Records stay contiguous: pad out the end of the buffer and wrap
+  if (ringTail + size > Config::CAPTURE_BUFFER_SIZE) {
+    uint32_t padding = Config::CAPTURE_BUFFER_SIZE - ringTail;
+    while (Config::CAPTURE_BUFFER_SIZE - ringUsed < padding) evictOldest();
+    if (padding >= CaptureFormat::RECORD_HEADER_SIZE) {
+      WireProto::store16(ring + ringTail + 4, RING_PADDING);
+    }
+    ringUsed += padding;
+    ringTail = 0;
+  }
+  while (Config::CAPTURE_BUFFER_SIZE - ringUsed < size) evictOldest();
+  
+  uint8_t* out = ring + ringTail;
+  memcpy(out, recordHeader, CaptureFormat::RECORD_HEADER_SIZE);
+  WireProto::store16(out + 4, length);
+  out += CaptureFormat::RECORD_HEADER_SIZE;
+  
+  int fromFirst = min(firstSize, (int)length);
+  memcpy(out, first, fromFirst);
+  if (length > fromFirst) memcpy(out + fromFirst, second, min(secondSize, length - fromFirst));
+  
+  ringTail += size;
+  ringUsed += size;
+  ringRecords++;
+}
+
+void PacketCapture::dump() {
+  // Host captures are already on disk
+  if (file || !ring) {
+    if (file) fflush(file);
+    printStatus();
+    return;
+  }
+  
+  if (!captureMutex || xSemaphoreTake(captureMutex, portMAX_DELAY) != pdTRUE) return;
+  
+  uint8_t header[CaptureFormat::FILE_HEADER_SIZE];
+  CaptureFormat::writeFileHeader(header, Config::CAPTURE_SNAP_LENGTH);
+  
+  // Hex lines of up to 32 bytes: file header, then each record
+  char line[65];
+  Serial.printf("CAPTURE BEGIN records=%d\n", ringRecords);
+  auto printHex = [&line](const uint8_t* data, uint32_t size) {
+    static const char digits[] = "0123456789abcdef";
+    for (uint32_t offset = 0; offset < size; offset += 32) {
+      uint32_t count = min(size - offset, (uint32_t)32);
+      for (uint32_t i = 0; i < count; i++) {
+        line[i * 2] = digits[data[offset + i] >> 4];
+        line[i * 2 + 1] = digits[data[offset + i] & 0x0F];
+      }
+      line[count * 2] = '\0';
+      Serial.println(line);
+    }
+  };
+  printHex(header, sizeof(header));
+  
+  uint32_t offset = ringHead;
+  uint32_t remaining = ringUsed;
+  while (remaining > 0) {
+    if (isPadding(offset)) {
+      remaining -= Config::CAPTURE_BUFFER_SIZE - offset;
+      offset = 0;
+      continue;
+    }
+    uint32_t size = CaptureFormat::RECORD_HEADER_SIZE + WireProto::load16(ring + offset + 4);
+    printHex(ring + offset, size);
+    offset += size;
+    remaining -= size;
+  }
+  Serial.println("CAPTURE END");
+  
+  xSemaphoreGive(captureMutex);
+}
+
+void PacketCapture::printStatus() const {
+  Serial.printf("Capture: %s, Records=%d, Overwritten=%d, Dropped=%d%s%s\n",
+               active ? "on" : "off", recordsCaptured, recordsOverwritten, recordsDropped,
+               file ? ", File=" : "", file ? Config::CAPTURE_FILE : "");
+}
@@ -3,19 +3,79 @@
 #define PERFORMANCE_MONITOR_H
 
 #include "config.h"
+#include "latency_histogram.h"
+
+// One task's share of its core and its stack headroom, from the last sample
+struct TaskUsage {
+  TaskHandle_t handle;
+  char name[16];
+  uint8_t core;
+  uint32_t stackSize;
+  uint32_t stackFree;     // High-water mark: the least free stack seen so far
+  uint16_t cpuPermille; // Of one core; WireProto::TELEMETRY_UNKNOWN without run-time stats
+  uint32_t lastRunTime;
+};
 
 class PerformanceMonitor {
+public:
+  enum LatencyStage : uint8_t {
+    LATENCY_ASSEMBLY,     // First packet -> frame complete
+    LATENCY_QUEUE,        // Frame complete -> decode start
+    LATENCY_DECODE,       // JPEG decode, pixel pushes excluded
+    LATENCY_TRANSFER,     // Pixels to the panel, the part not hidden behind decode
+    LATENCY_END_TO_END,   // First packet -> pixels on glass
+    LATENCY_STAGE_COUNT
+  };
+  
 private:
   uint32_t totalFramesStarted;
   uint32_t completeFramesReceived;
   uint32_t completeFramesRendered;
   uint32_t incompleteFramesDiscarded;
+  uint32_t evictedFramesDiscarded;
   uint32_t corruptFramesDiscarded;
+  uint32_t skippedFrames;
+  uint32_t packetsLost;
+  uint32_t packetsRecovered;
+  uint32_t earlyRebuilds;       // Rebuilt packets whose original arrived after all
+  uint32_t dataBytesReceived;
+  uint32_t parityBytesReceived;
+  uint32_t retransmitRequests;
+  uint32_t packetsRequested;
+  uint32_t packetsRetransmitted;
+  uint32_t framesRepaired;
   uint32_t memoryErrors;
+  uint32_t overlapFrames;
+  uint64_t stripDmaBusyTime;    // µs; 64-bit so the two never wrap apart
+  uint64_t stripDmaWaitTime;
+  uint16_t lastOverlapPermille;
+  uint32_t deltaFrames;
+  uint64_t blocksChecked;       // 64-bit, like the DMA times, so the ratio survives
+  uint64_t blocksChanged;
+  uint64_t deltaBytesSaved;
+  uint16_t lastChangedPermille;
+  LatencyHistogram latency[LATENCY_STAGE_COUNT];
+  uint32_t telemetrySequence;
+  TaskUsage taskUsage[Config::MAX_MONITORED_TASKS];
+  uint8_t taskUsageCount;
+  uint16_t coreIdlePermille[2];
+  uint32_t lastIdleRunTime[2];
+  uint32_t lastTotalRunTime;
+  
+  void sampleRunTimes();
   
   PerformanceMonitor() : totalFramesStarted(0), completeFramesReceived(0),
                         completeFramesRendered(0), incompleteFramesDiscarded(0),
-                        corruptFramesDiscarded(0), memoryErrors(0) {}
+                        evictedFramesDiscarded(0), corruptFramesDiscarded(0), skippedFrames(0),
+                        packetsLost(0), packetsRecovered(0), earlyRebuilds(0), dataBytesReceived(0),
+                        parityBytesReceived(0), retransmitRequests(0), packetsRequested(0),
+                        packetsRetransmitted(0), framesRepaired(0), memoryErrors(0),
+                        overlapFrames(0), stripDmaBusyTime(0), stripDmaWaitTime(0),
+                        lastOverlapPermille(0), deltaFrames(0), blocksChecked(0), blocksChanged(0),
+                        deltaBytesSaved(0), lastChangedPermille(0), telemetrySequence(0), taskUsageCount(0), lastTotalRunTime(0) {
+    coreIdlePermille[0] = coreIdlePermille[1] = WireProto::TELEMETRY_UNKNOWN;
+    lastIdleRunTime[0] = lastIdleRunTime[1] = 0;
+  }
   
 public:
   static PerformanceMonitor& getInstance() {
@@ -28,21 +88,71 @@ public:
   void incrementCompleteFrames() { completeFramesReceived++; }
   void incrementRenderedFrames() { completeFramesRendered++; }
   void incrementIncompleteFrames() { incompleteFramesDiscarded++; }
+  void incrementEvictedFrames() { evictedFramesDiscarded++; }
   void incrementCorruptFrames() { corruptFramesDiscarded++; }
+  void incrementSkippedFrames() { skippedFrames++; }
+  void addLostPackets(uint32_t count) { packetsLost += count; }
+  void incrementRecoveredPackets() { packetsRecovered++; }
+  // A rebuilt packet whose original turned up late: reordered, not lost
+  void incrementEarlyRebuilds() { if (packetsRecovered) packetsRecovered--; earlyRebuilds++; }
+  void addDataBytes(uint32_t bytes) { dataBytesReceived += bytes; }
+  void addParityBytes(uint32_t bytes) { parityBytesReceived += bytes; }
+  void incrementRetransmitRequests() { retransmitRequests++; }
+  void addRequestedPackets(uint32_t count) { packetsRequested += count; }
+  void incrementRetransmittedPackets() { packetsRetransmitted++; }
+  void incrementRepairedFrames() { framesRepaired++; }
   void incrementMemoryErrors() { memoryErrors++; }
   
+  // Lock-free, callable from either core
+  void recordLatency(LatencyStage stage, uint32_t us) { latency[stage].record(us); }
+  const LatencyHistogram& getLatency(LatencyStage stage) const { return latency[stage]; }
+  
+  // One frame's DMA strip transfers: total busy time and the part the render
+  // path waited for; the rest ran while the decoder worked
+  void recordStripOverlap(uint32_t busyUs, uint32_t waitUs);
+  
+  // One frame's delta update: blocks compared, blocks that changed and were
+  // sent, and the bytes the unchanged ones kept off the SPI bus
+  void recordBlockDelta(uint32_t changed, uint32_t checked, uint32_t bytesSaved);
+  
   // Getters
   uint32_t getFramesStarted() const { return totalFramesStarted; }
   uint32_t getCompleteFrames() const { return completeFramesReceived; }
   uint32_t getRenderedFrames() const { return completeFramesRendered; }
   uint32_t getIncompleteFrames() const { return incompleteFramesDiscarded; }
+  uint32_t getEvictedFrames() const { return evictedFramesDiscarded; }
   uint32_t getCorruptFrames() const { return corruptFramesDiscarded; }
+  uint32_t getSkippedFrames() const { return skippedFrames; }
+  uint32_t getPacketsLost() const { return packetsLost; }
+  uint32_t getRecoveredPackets() const { return packetsRecovered; }
+  uint32_t getEarlyRebuilds() const { return earlyRebuilds; }
+  uint32_t getRetransmitRequests() const { return retransmitRequests; }
+  uint32_t getRepairedFrames() const { return framesRepaired; }
   uint32_t getMemoryErrors() const { return memoryErrors; }
   
+  // Task usage as of the last sampleTasks()
+  uint8_t getTaskCount() const { return taskUsageCount; }
+  const TaskUsage& getTaskUsage(uint8_t index) const { return taskUsage[index]; }
+  uint16_t getCoreIdlePermille(uint8_t core) const { return coreIdlePermille[core & 1]; }
+  
   // Statistics
   float getCompletionRate() const;
+  float getParityOverhead() const;
   float getRenderRate() const;
+  float getStripOverlap() const;   // % of DMA transfer time hidden behind decode
+  float getChangedBlockRatio() const;   // % of blocks sent since the last reset
+  void reset();
   void printStatistics() const;
+  void printLatency() const;
+  void printTasks() const;
+  
+  // Samples stack high-water marks and, with FreeRTOS run-time stats, each
+  // task's and each idle task's CPU time since the previous call
+  void sampleTasks();
+  
+  // Binary report of every counter, the latency percentiles, heap and task
+  // stacks (WireProto telemetry layout); returns its size, 0 if it does not fit
+  int buildTelemetry(uint8_t* report, int maxSize);
   void checkMemory();
 };
 
@@ -52,17 +162,61 @@ public:
 #include "performance_monitor.h"
 #include "frame_processor.h"
 #include "network_manager.h"
+#include "network_impairment.h"
+#include "packet_capture.h"
+#include "async_logger.h"
+#include "task_manager.h"
 
 float PerformanceMonitor::getCompletionRate() const {
   return totalFramesStarted > 0 ? 
          (float)completeFramesReceived / totalFramesStarted * 100.0f : 0.0f;
 }
 
+float PerformanceMonitor::getParityOverhead() const {
+  return dataBytesReceived > 0 ? 
+         (float)parityBytesReceived / dataBytesReceived * 100.0f : 0.0f;
+}
+
+float PerformanceMonitor::getStripOverlap() const {
+  return stripDmaBusyTime > 0 ? 
+         100.0f - (float)stripDmaWaitTime / stripDmaBusyTime * 100.0f : 0.0f;
+}
+
+void PerformanceMonitor::recordStripOverlap(uint32_t busyUs, uint32_t waitUs) {
+  overlapFrames++;
+  stripDmaBusyTime += busyUs;
+  stripDmaWaitTime += waitUs;
+  lastOverlapPermille = busyUs > 0 ? 1000 - (uint32_t)((uint64_t)waitUs * 1000 / busyUs) : 0;
+}
+
+float PerformanceMonitor::getChangedBlockRatio() const {
+  return blocksChecked > 0 ? (float)blocksChanged / blocksChecked * 100.0f : 0.0f;
+}
+
+void PerformanceMonitor::recordBlockDelta(uint32_t changed, uint32_t checked, uint32_t bytesSaved) {
+  deltaFrames++;
+  blocksChecked += checked;
+  blocksChanged += changed;
+  deltaBytesSaved += bytesSaved;
+  lastChangedPermille = checked > 0 ? (uint32_t)((uint64_t)changed * 1000 / checked) : 0;
+}
+
 float PerformanceMonitor::getRenderRate() const {
   return completeFramesReceived > 0 ? 
          (float)completeFramesRendered / completeFramesReceived * 100.0f : 0.0f;
 }
 
+void PerformanceMonitor::reset() {
+  totalFramesStarted = completeFramesReceived = completeFramesRendered = 0;
+  incompleteFramesDiscarded = evictedFramesDiscarded = corruptFramesDiscarded = skippedFrames = 0;
+  packetsLost = packetsRecovered = earlyRebuilds = dataBytesReceived = parityBytesReceived = 0;
+  retransmitRequests = packetsRequested = packetsRetransmitted = framesRepaired = 0;
+  memoryErrors = 0;
+  overlapFrames = stripDmaBusyTime = stripDmaWaitTime = lastOverlapPermille = 0;
+  deltaFrames = blocksChecked = blocksChanged = deltaBytesSaved = lastChangedPermille = 0;
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) latency[i].reset();
+}
+
 void PerformanceMonitor::printStatistics() const {
   CompleteFrameState& currentFrame = FrameProcessor::getInstance().getCurrentFrame();
   uint32_t heapFree = ESP.getFreeHeap();
@@ -72,16 +226,230 @@ void PerformanceMonitor::printStatistics() const {
                totalFramesStarted, completeFramesReceived, getCompletionRate());
   Serial.printf("Rendered: %d (%.1f%% of complete)\n", 
                completeFramesRendered, getRenderRate());
-  Serial.printf("Discarded: Incomplete=%d, Corrupt=%d\n", 
-               incompleteFramesDiscarded, corruptFramesDiscarded);
+  Serial.printf("Discarded: Incomplete=%d, Evicted=%d, Corrupt=%d, Skipped=%d\n", 
+               incompleteFramesDiscarded, evictedFramesDiscarded, corruptFramesDiscarded, 
+               skippedFrames);
+  Serial.printf("Packets lost in discarded frames: %d\n", packetsLost);
+  Serial.printf("FEC: Recovered=%d packets, Rebuilt early=%d, Parity overhead=%.1f%%\n", 
+               packetsRecovered, earlyRebuilds, getParityOverhead());
+  Serial.printf("Retransmit: Requests=%d, Packets=%d/%d, Repaired=%d, RTT=%dms\n", 
+               retransmitRequests, packetsRetransmitted, packetsRequested, framesRepaired, 
+               FrameProcessor::getInstance().getRetransmitRtt());
+  NetworkImpairment::getInstance().printStatistics();
+  if (PacketCapture::getInstance().isActive()) {
+    PacketCapture::getInstance().printStatus();
+  }
+  printLatency();
+  if (overlapFrames > 0) {
+    Serial.printf("Strip DMA: Overlap=%.1f%% (last frame %.1f%%), Wait=%d us/frame\n", 
+                 getStripOverlap(), lastOverlapPermille / 10.0f, (uint32_t)(stripDmaWaitTime / overlapFrames));
+  }
+  if (deltaFrames > 0) {
+    Serial.printf("Block delta: Changed=%.1f%% (last frame %.1f%%), Saved=%d KB (%d KB/frame)\n", 
+                 getChangedBlockRatio(), lastChangedPermille / 10.0f, (uint32_t)(deltaBytesSaved / 1024), 
+                 (uint32_t)(deltaBytesSaved / 1024 / deltaFrames));
+  }
+  printTasks();
   Serial.printf("Current: ID=%d, Packets=%d/%d, Size=%d\n", 
                currentFrame.frameId, currentFrame.receivedPackets, 
                currentFrame.totalPackets, currentFrame.totalSize);
+  Serial.printf("Reassembly slots: %d/%d active\n", 
+               FrameProcessor::getInstance().getActiveSlots(), Config::REASSEMBLY_SLOTS);
   Serial.printf("Memory: Free=%d KB, Errors=%d\n", heapFree/1024, memoryErrors);
+  AsyncLogger::getInstance().printStatus();
   Serial.printf("Clients: %d\n", NetworkManager::getInstance().getConnectedClients());
   Serial.println("=============================");
 }
 
+void PerformanceMonitor::printLatency() const {
+  static const char* stageNames[LATENCY_STAGE_COUNT] = {
+    "Assembly", "Queue", "Decode", "Transfer", "End-to-end"
+  };
+  
+  Serial.printf("Latency (us)      p50      p90      p99      max    count\n");
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    const LatencyHistogram& histogram = latency[i];
+    Serial.printf("  %-10s %8d %8d %8d %8d %8d\n", stageNames[i], 
+                 histogram.getPercentile(0.50f), histogram.getPercentile(0.90f), 
+                 histogram.getPercentile(0.99f), histogram.getMax(), histogram.getCount());
+  }
+}
+
+void PerformanceMonitor::printTasks() const {
+  if (taskUsageCount == 0) return;
+  
+  Serial.printf("Tasks              core   cpu    stack free/size\n");
+  for (uint8_t i = 0; i < taskUsageCount; i++) {
+    const TaskUsage& task = taskUsage[i];
+    if (task.cpuPermille == WireProto::TELEMETRY_UNKNOWN) {
+      Serial.printf("  %-18s %d     n/a %8d/%d\n", task.name, task.core, 
+                   task.stackFree, task.stackSize);
+    } else {
+      Serial.printf("  %-18s %d  %5.1f%% %8d/%d\n", task.name, task.core, 
+                   task.cpuPermille / 10.0f, task.stackFree, task.stackSize);
+    }
+  }
+  if (coreIdlePermille[0] != WireProto::TELEMETRY_UNKNOWN) {
+    Serial.printf("Idle: Core0=%.1f%%, Core1=%.1f%%\n", 
+                 coreIdlePermille[0] / 10.0f, coreIdlePermille[1] / 10.0f);
+  }
+}
+
+void PerformanceMonitor::sampleTasks() {
+  TaskInfo tasks[Config::MAX_MONITORED_TASKS];
+  uint8_t count = TaskManager::getInstance().getTasks(tasks, Config::MAX_MONITORED_TASKS);
+  
+  for (uint8_t i = 0; i < count; i++) {
+    TaskUsage& usage = taskUsage[i];
+    if (usage.handle != tasks[i].handle || i >= taskUsageCount) {
+      usage.handle = tasks[i].handle;
+      strncpy(usage.name, pcTaskGetName(tasks[i].handle), sizeof(usage.name) - 1);
+      usage.name[sizeof(usage.name) - 1] = '\0';
+      usage.lastRunTime = 0;
+    }
+    usage.core = tasks[i].core;
+    usage.stackSize = tasks[i].stackSize;
+    usage.stackFree = uxTaskGetStackHighWaterMark(tasks[i].handle);
+    usage.cpuPermille = WireProto::TELEMETRY_UNKNOWN;
+  }
+  taskUsageCount = count;
+  
+  sampleRunTimes();
+}
+
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+static bool findRunTime(const TaskStatus_t* status, UBaseType_t count, TaskHandle_t handle, 
+                        uint32_t& runTime) {
+  for (UBaseType_t i = 0; i < count; i++) {
+    if (status[i].xHandle == handle) {
+      runTime = status[i].ulRunTimeCounter;
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint16_t permille(uint32_t part, uint32_t whole) {
+  uint32_t value = (uint32_t)((uint64_t)part * 1000 / whole);
+  return value > 1000 ? 1000 : value;
+}
+#endif
+
+// Needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS, which the stock Arduino core
+// leaves off; the CPU figures then stay unknown and only stacks are reported
+void PerformanceMonitor::sampleRunTimes() {
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+  // Over 1 KB: static rather than on the monitor task's stack
+  static TaskStatus_t status[Config::MAX_SYSTEM_TASKS];
+  uint32_t totalRunTime = 0;
+  UBaseType_t statusCount = uxTaskGetSystemState(status, Config::MAX_SYSTEM_TASKS, &totalRunTime);
+  uint32_t elapsed = totalRunTime - lastTotalRunTime;
+  if (statusCount == 0 || elapsed == 0) return;
+  lastTotalRunTime = totalRunTime;
+  
+  // The run-time clock is per core, so each share is of one core
+  uint32_t runTime;
+  for (uint8_t i = 0; i < taskUsageCount; i++) {
+    TaskUsage& usage = taskUsage[i];
+    if (findRunTime(status, statusCount, usage.handle, runTime)) {
+      usage.cpuPermille = permille(runTime - usage.lastRunTime, elapsed);
+      usage.lastRunTime = runTime;
+    }
+  }
+  
+  for (uint8_t core = 0; core < 2; core++) {
+    if (findRunTime(status, statusCount, xTaskGetIdleTaskHandleForCPU(core), runTime)) {
+      coreIdlePermille[core] = permille(runTime - lastIdleRunTime[core], elapsed);
+      lastIdleRunTime[core] = runTime;
+    }
+  }
+#endif
+}
+
+int PerformanceMonitor::buildTelemetry(uint8_t* report, int maxSize) {
+  static_assert(LATENCY_STAGE_COUNT <= WireProto::TELEMETRY_MAX_STAGES, "telemetry stage room");
+  
+  uint8_t taskCount = taskUsageCount < WireProto::TELEMETRY_MAX_TASKS ? taskUsageCount : WireProto::TELEMETRY_MAX_TASKS;
+  int size = WireProto::TELEMETRY_HEADER_SIZE + WireProto::TELEMETRY_COUNTER_COUNT * 4 +
+             LATENCY_STAGE_COUNT * WireProto::TELEMETRY_STAGE_FIELDS * 4 +
+             taskCount * WireProto::TELEMETRY_TASK_ENTRY_SIZE;
+  if (!report || size > maxSize) return 0;
+  
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  AsyncLogger& logger = AsyncLogger::getInstance();
+  
+  memset(report, 0, size);
+  WireProto::store32(report, WireProto::TELEMETRY_MAGIC);
+  report[4] = WireProto::TELEMETRY_VERSION;
+  report[5] = WireProto::TELEMETRY_HEADER_SIZE;
+  report[6] = WireProto::TELEMETRY_COUNTER_COUNT;
+  report[7] = LATENCY_STAGE_COUNT;
+  report[8] = taskCount;
+  report[9] = WireProto::TELEMETRY_TASK_ENTRY_SIZE;
+  report[10] = fp.getActiveSlots();
+  WireProto::store32(report + 12, telemetrySequence++);
+  WireProto::store32(report + 16, millis());
+  WireProto::store32(report + 20, ESP.getFreeHeap());
+  WireProto::store32(report + 24, ESP.getMinFreeHeap());
+  WireProto::store16(report + 28, fp.getRetransmitRtt());
+  
+  uint32_t counters[WireProto::TELEMETRY_COUNTER_COUNT];
+  counters[WireProto::TM_FRAMES_STARTED] = totalFramesStarted;
+  counters[WireProto::TM_FRAMES_COMPLETE] = completeFramesReceived;
+  counters[WireProto::TM_FRAMES_RENDERED] = completeFramesRendered;
+  counters[WireProto::TM_FRAMES_INCOMPLETE] = incompleteFramesDiscarded;
+  counters[WireProto::TM_FRAMES_EVICTED] = evictedFramesDiscarded;
+  counters[WireProto::TM_FRAMES_CORRUPT] = corruptFramesDiscarded;
+  counters[WireProto::TM_FRAMES_SKIPPED] = skippedFrames;
+  counters[WireProto::TM_PACKETS_LOST] = packetsLost;
+  counters[WireProto::TM_PACKETS_RECOVERED] = packetsRecovered;
+  counters[WireProto::TM_PACKETS_REBUILT_EARLY] = earlyRebuilds;
+  counters[WireProto::TM_DATA_BYTES] = dataBytesReceived;
+  counters[WireProto::TM_PARITY_BYTES] = parityBytesReceived;
+  counters[WireProto::TM_RETRANSMIT_REQUESTS] = retransmitRequests;
+  counters[WireProto::TM_PACKETS_REQUESTED] = packetsRequested;
+  counters[WireProto::TM_PACKETS_RETRANSMITTED] = packetsRetransmitted;
+  counters[WireProto::TM_FRAMES_REPAIRED] = framesRepaired;
+  counters[WireProto::TM_MEMORY_ERRORS] = memoryErrors;
+  counters[WireProto::TM_LOG_MESSAGES] = logger.getLoggedMessages();
+  counters[WireProto::TM_LOG_DROPPED] = logger.getDroppedMessages();
+  counters[WireProto::TM_CLIENTS] = NetworkManager::getInstance().getConnectedClients();
+  counters[WireProto::TM_CORE0_IDLE_PERMILLE] = coreIdlePermille[0];
+  counters[WireProto::TM_CORE1_IDLE_PERMILLE] = coreIdlePermille[1];
+  counters[WireProto::TM_STRIP_DMA_BUSY_US] = (uint32_t)stripDmaBusyTime; // Low words: diff reports mod 2^32
+  counters[WireProto::TM_STRIP_DMA_WAIT_US] = (uint32_t)stripDmaWaitTime;
+  counters[WireProto::TM_BLOCKS_CHECKED] = (uint32_t)blocksChecked;
+  counters[WireProto::TM_BLOCKS_CHANGED] = (uint32_t)blocksChanged;
+  counters[WireProto::TM_DELTA_BYTES_SAVED] = (uint32_t)deltaBytesSaved;
+  
+  uint8_t* out = report + WireProto::TELEMETRY_HEADER_SIZE;
+  for (uint8_t i = 0; i < WireProto::TELEMETRY_COUNTER_COUNT; i++, out += 4) {
+    WireProto::store32(out, counters[i]);
+  }
+  
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    const LatencyHistogram& histogram = latency[i];
+    WireProto::store32(out, histogram.getCount());
+    WireProto::store32(out + 4, histogram.getPercentile(0.50f));
+    WireProto::store32(out + 8, histogram.getPercentile(0.90f));
+    WireProto::store32(out + 12, histogram.getPercentile(0.99f));
+    WireProto::store32(out + 16, histogram.getMax());
+    out += WireProto::TELEMETRY_STAGE_FIELDS * 4;
+  }
+  
+  for (uint8_t i = 0; i < taskCount; i++) {
+    const TaskUsage& task = taskUsage[i];
+    strncpy((char*)out, task.name, WireProto::TELEMETRY_TASK_NAME_SIZE - 1);
+    WireProto::store32(out + WireProto::TELEMETRY_TASK_NAME_SIZE, task.stackFree);
+    WireProto::store32(out + WireProto::TELEMETRY_TASK_NAME_SIZE + 4, task.stackSize);
+    WireProto::store16(out + WireProto::TELEMETRY_TASK_NAME_SIZE + 8, task.cpuPermille);
+    out[WireProto::TELEMETRY_TASK_NAME_SIZE + 10] = task.core;
+    out += WireProto::TELEMETRY_TASK_ENTRY_SIZE;
+  }
+  
+  return size;
+}
+
 void PerformanceMonitor::checkMemory() {
   if (ESP.getFreeHeap() < Config::MIN_HEAP_SIZE) {
     memoryErrors++;
@@ -1,6 +1,7 @@
 #include "esp_camera.h"
 #include <WiFi.h>
 #include <WiFiUdp.h>
+#include "wire_protocol.h"
 
 #define CAMERA_MODEL_AI_THINKER // Has PSRAM
 #include "camera_pins.h"
@@ -12,7 +13,19 @@ const char* password = "12345678";
 // UDP settings - Send to WROOM's IP
 const char *udpAddress = "192.168.4.1";  // WROOM's AP IP
 const int udpPort = 4210;
-const int maxPacketSize = 1400;
+
+// Packet header layout: 2 (magic, flags, capture time) or 1 for older WROOM firmware
+#define WIRE_PROTOCOL_VERSION 2
+
+// Forward error correction: one XOR parity packet follows every FEC_GROUP_SIZE
+// data packets, so the WROOM can rebuild a single lost packet per group.
+// Set to 0 to disable parity packets.
+#define FEC_GROUP_SIZE 5
+
+// Selective retransmission: the last frames sent are kept in PSRAM so packets
+// the WROOM reports missing (NACK) can be resent. Set to 0 to disable.
+#define RETRANSMIT_HISTORY 2
+#define RETRANSMIT_MAX_FRAME_SIZE 40000
 
 // LED for status indication
 #define LED_PIN 33
@@ -30,9 +43,23 @@ const int frameInterval = 200;     // 5 fps (200ms between frames)
 // UDP instance
 WiFiUDP udp;
 
+#if RETRANSMIT_HISTORY > 0
+// Copies of recently sent frames for retransmission
+struct SentFrame {
+  uint32_t frameId;
+  size_t len;
+  uint32_t captureTimeUs;
+  uint8_t* data;
+};
+SentFrame sentFrames[RETRANSMIT_HISTORY];
+#endif
+
 // Frame counter and statistics
 uint32_t frameCount = 0;
 uint32_t packetCount = 0;
+uint32_t parityPacketCount = 0;
+uint32_t retransmitRequests = 0;
+uint32_t retransmittedPackets = 0;
 uint32_t successfulFrames = 0;
 uint32_t failedFrames = 0;
 unsigned long lastStatsTime = 0;
@@ -153,6 +180,18 @@ void setup() {
   udp.begin(udpPort);
   Serial.printf("✓ UDP started on port %d\n", udpPort);
   
+#if RETRANSMIT_HISTORY > 0
+  // Retransmit history in PSRAM
+  for (int i = 0; i < RETRANSMIT_HISTORY; i++) {
+    sentFrames[i].frameId = 0;
+    sentFrames[i].len = 0;
+    sentFrames[i].data = (uint8_t*)ps_malloc(RETRANSMIT_MAX_FRAME_SIZE);
+    if (!sentFrames[i].data) {
+      Serial.println("⚠️ No PSRAM for retransmit history, NACKs will be ignored");
+    }
+  }
+#endif
+  
   // Test UDP connectivity
   Serial.printf("Testing UDP connectivity to WROOM at %s:%d\n", udpAddress, udpPort);
   testUDPConnection();
@@ -223,6 +262,9 @@ void loop() {
     return;
   }
   
+  // Resend packets the WROOM asked for between frames
+  handleRetransmitRequests();
+  
   // Frame rate control
   unsigned long currentTime = millis();
   if (currentTime - previousFrameTime < frameInterval) {
@@ -289,12 +331,15 @@ void loop() {
 bool sendFrameToWROOM(camera_fb_t *fb) {
   // Calculate number of packets needed
   size_t totalBytes = fb->len;
-  uint16_t totalPackets = (totalBytes + maxPacketSize - 12 - 1) / (maxPacketSize - 12);
+  uint16_t totalPackets = (totalBytes + WireProto::PAYLOAD_SIZE - 1) / WireProto::PAYLOAD_SIZE;
   
-  // Prepare header with frame info
-  uint8_t headerData[8];
-  memcpy(headerData, &frameCount, 4);      // Frame ID
-  memcpy(headerData + 4, &totalPackets, 2); // Total packets
+  // Fields shared by every packet of this frame
+  WireProto::PacketHeader frame;
+  frame.flags = 0;
+  frame.frameId = frameCount;
+  frame.frameLength = totalBytes;
+  frame.totalPackets = totalPackets;
+  frame.captureTimeUs = (uint32_t)(fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec);
   
   // Log frame info for first few frames
   if (frameCount <= 5) {
@@ -304,31 +349,29 @@ bool sendFrameToWROOM(camera_fb_t *fb) {
   
   bool allPacketsSuccess = true;
   
+#if RETRANSMIT_HISTORY > 0
+  // Keep a copy for retransmission; the camera buffer goes back to the driver
+  SentFrame& history = sentFrames[frameCount % RETRANSMIT_HISTORY];
+  history.frameId = 0;
+  if (history.data && totalBytes <= RETRANSMIT_MAX_FRAME_SIZE) {
+    memcpy(history.data, fb->buf, totalBytes);
+    history.len = totalBytes;
+    history.captureTimeUs = frame.captureTimeUs;
+    history.frameId = frameCount;
+  }
+#endif
+  
+#if FEC_GROUP_SIZE > 0
+  // Running XOR of the current group, zero-padded to a full payload
+  static uint8_t parityPacket[WireProto::MAX_HEADER_SIZE + WireProto::PARITY_PAYLOAD_SIZE];
+  uint8_t* parityPayload = parityPacket + WireProto::MAX_HEADER_SIZE;
+  uint16_t parityLength = 0;
+  memset(parityPayload, 0, WireProto::PARITY_PAYLOAD_SIZE);
+#endif
+  
   // Send each packet to WROOM
   for (uint16_t packetIndex = 0; packetIndex < totalPackets; packetIndex++) {
-    // Calculate chunk size for this packet
-    size_t offset = packetIndex * (maxPacketSize - 12);
-    size_t packetDataSize = min(maxPacketSize - 12, (int)(totalBytes - offset));
-    
-    // Create packet: [frameCount(4)][totalPackets(2)][packetIndex(2)][packetSize(4)][data]
-    uint8_t packetBuffer[12 + packetDataSize];
-    
-    // Copy header
-    memcpy(packetBuffer, headerData, 6);
-    
-    // Add packet index
-    memcpy(packetBuffer + 6, &packetIndex, 2);
-    
-    // Add packet data size
-    memcpy(packetBuffer + 8, &packetDataSize, 4);
-    
-    // Copy image data for this packet
-    memcpy(packetBuffer + 12, fb->buf + offset, packetDataSize);
-    
-    // Send UDP packet to WROOM
-    udp.beginPacket(udpAddress, udpPort);
-    udp.write(packetBuffer, sizeof(packetBuffer));
-    bool success = udp.endPacket();
+    bool success = sendDataPacket(frame, fb->buf, packetIndex, 0);
     
     if (success) {
       packetCount++;
@@ -339,6 +382,43 @@ bool sendFrameToWROOM(camera_fb_t *fb) {
       allPacketsSuccess = false;
     }
     
+#if FEC_GROUP_SIZE > 0
+    // Fold this packet into the group parity; close the group when it is full
+    // or the frame ends
+    size_t offset = packetIndex * WireProto::PAYLOAD_SIZE;
+    size_t packetDataSize = min((size_t)WireProto::PAYLOAD_SIZE, totalBytes - offset);
+    WireProto::xorPayload(parityPayload + WireProto::PARITY_HEADER_SIZE, fb->buf + offset, packetDataSize);
+    parityLength ^= packetDataSize;
+    
+    if ((packetIndex + 1) % FEC_GROUP_SIZE == 0 || packetIndex == totalPackets - 1) {
+      delay(1);
+      
+      WireProto::PacketHeader parity = frame;
+      parity.flags = WireProto::FLAG_PARITY;
+      parity.packetIndex = totalPackets + packetIndex / FEC_GROUP_SIZE;
+      parity.byteOffset = (packetIndex / FEC_GROUP_SIZE) * FEC_GROUP_SIZE * WireProto::PAYLOAD_SIZE;
+      parity.payloadLength = WireProto::PARITY_PAYLOAD_SIZE;
+      
+      // Header is written right in front of the payload it describes
+      uint8_t headerBuffer[WireProto::MAX_HEADER_SIZE];
+      int headerSize = WireProto::writeHeader(headerBuffer, parity, WIRE_PROTOCOL_VERSION);
+      uint8_t* packetStart = parityPayload - headerSize;
+      memcpy(packetStart, headerBuffer, headerSize);
+      parityPayload[0] = FEC_GROUP_SIZE;
+      parityPayload[1] = 0;
+      WireProto::store16(parityPayload + 2, parityLength);
+      
+      udp.beginPacket(udpAddress, udpPort);
+      udp.write(packetStart, headerSize + WireProto::PARITY_PAYLOAD_SIZE);
+      if (udp.endPacket()) {
+        parityPacketCount++;
+      }
+      
+      memset(parityPayload, 0, WireProto::PARITY_PAYLOAD_SIZE);
+      parityLength = 0;
+    }
+#endif
+    
     // Small delay to prevent UDP buffer overflow
     delay(1);
   }
@@ -346,6 +426,69 @@ bool sendFrameToWROOM(camera_fb_t *fb) {
   return allPacketsSuccess;
 }
 
+bool sendDataPacket(const WireProto::PacketHeader& frame, const uint8_t* frameData, 
+                    uint16_t packetIndex, uint8_t flags) {
+  size_t offset = packetIndex * WireProto::PAYLOAD_SIZE;
+  size_t packetDataSize = min((size_t)WireProto::PAYLOAD_SIZE, frame.frameLength - offset);
+  
+  WireProto::PacketHeader header = frame;
+  header.flags = flags;
+  header.packetIndex = packetIndex;
+  header.byteOffset = offset;
+  header.payloadLength = packetDataSize;
+  
+  // Create packet: [header][data]
+  uint8_t packetBuffer[WireProto::MAX_HEADER_SIZE + packetDataSize];
+  int headerSize = WireProto::writeHeader(packetBuffer, header, WIRE_PROTOCOL_VERSION);
+  memcpy(packetBuffer + headerSize, frameData + offset, packetDataSize);
+  
+  // Send UDP packet to WROOM
+  udp.beginPacket(udpAddress, udpPort);
+  udp.write(packetBuffer, headerSize + packetDataSize);
+  return udp.endPacket();
+}
+
+void handleRetransmitRequests() {
+  uint8_t request[WireProto::NACK_MAX_SIZE];
+  
+  while (udp.parsePacket() > 0) {
+    int bytesRead = udp.read(request, sizeof(request));
+    
+#if RETRANSMIT_HISTORY > 0
+    if (bytesRead < WireProto::NACK_HEADER_SIZE || WireProto::load32(request) != WireProto::NACK_MAGIC) continue;
+    
+    uint32_t frameId = WireProto::load32(request + 4);
+    uint16_t totalPackets = WireProto::load16(request + 8);
+    uint16_t base = WireProto::load16(request + 10);
+    uint16_t bitmapBytes = WireProto::load16(request + 12);
+    if (WireProto::NACK_HEADER_SIZE + bitmapBytes > bytesRead) continue;
+    
+    // Only frames still in the history can be repaired
+    SentFrame& history = sentFrames[frameId % RETRANSMIT_HISTORY];
+    if (history.frameId != frameId || frameId == 0) continue;
+    
+    WireProto::PacketHeader frame;
+    frame.frameId = frameId;
+    frame.frameLength = history.len;
+    frame.totalPackets = (history.len + WireProto::PAYLOAD_SIZE - 1) / WireProto::PAYLOAD_SIZE;
+    frame.captureTimeUs = history.captureTimeUs;
+    if (totalPackets != frame.totalPackets) continue;
+    
+    retransmitRequests++;
+    for (uint16_t bit = 0; bit < bitmapBytes * 8; bit++) {
+      if (!(request[WireProto::NACK_HEADER_SIZE + bit / 8] & (1 << (bit & 7)))) continue;
+      
+      uint16_t packetIndex = base + bit;
+      if (packetIndex >= totalPackets) break;
+      
+      if (sendDataPacket(frame, history.data, packetIndex, WireProto::FLAG_RETRANSMIT)) {
+        retransmittedPackets++;
+      }
+    }
+#endif
+  }
+}
+
 void printDetailedStats() {
   unsigned long uptime = millis() / 1000;
   float actualFps = (float)frameCount / (uptime > 0 ? uptime : 1);
@@ -358,6 +501,14 @@ void printDetailedStats() {
                frameCount, successfulFrames, failedFrames);
   Serial.printf("Success rate: %.1f%%\n", successRate);
   Serial.printf("Packets sent: %u\n", packetCount);
+#if FEC_GROUP_SIZE > 0
+  Serial.printf("Parity packets sent: %u (1 per %d data packets)\n", 
+               parityPacketCount, FEC_GROUP_SIZE);
+#endif
+#if RETRANSMIT_HISTORY > 0
+  Serial.printf("Retransmits: %u requests, %u packets resent\n", 
+               retransmitRequests, retransmittedPackets);
+#endif
   Serial.printf("Actual FPS: %.2f\n", actualFps);
   Serial.printf("WiFi signal: %d dBm\n", WiFi.RSSI());
   Serial.printf("Free heap: %d bytes\n", ESP.getFreeHeap());
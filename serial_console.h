@@ -0,0 +1,76 @@
+// serial_console.h
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include "config.h"
+
+// Line-based debug commands on the serial port, polled by the monitor task
+class SerialConsole {
+private:
+  char line[48];
+  uint8_t length;
+  
+  SerialConsole() : length(0) {}
+  
+  void execute(const char* command);
+  
+public:
+  static SerialConsole& getInstance() {
+    static SerialConsole instance;
+    return instance;
+  }
+  
+  // Consumes whatever input is waiting, never blocks
+  void poll();
+};
+
+#endif // SERIAL_CONSOLE_H
+
+// serial_console.cpp
+#include "serial_console.h"
+#include "performance_monitor.h"
+#include "packet_capture.h"
+#include "trace_recorder.h"
+
+void SerialConsole::poll() {
+  int c;
+  while ((c = Serial.read()) >= 0) {
+    if (c == '\r' || c == '\n') {
+      if (length == 0) continue;
+      line[length] = '\0';
+      length = 0;
+      execute(line);
+    } else if (length < sizeof(line) - 1) {
+      line[length++] = (char)c;
+    }
+  }
+}
+
+void SerialConsole::execute(const char* command) {
+  PacketCapture& capture = PacketCapture::getInstance();
+  TraceRecorder& trace = TraceRecorder::getInstance();
+  
+  if (strcmp(command, "stats") == 0) {
+    PerformanceMonitor::getInstance().printStatistics();
+  } else if (strcmp(command, "tasks") == 0) {
+    PerformanceMonitor::getInstance().printTasks();
+  } else if (strcmp(command, "capture start") == 0) {
+    capture.start();
+  } else if (strcmp(command, "capture stop") == 0) {
+    capture.stop();
+  } else if (strcmp(command, "capture dump") == 0) {
+    capture.dump();
+  } else if (strcmp(command, "capture") == 0) {
+    capture.printStatus();
+  } else if (strcmp(command, "trace start") == 0) {
+    trace.start();
+  } else if (strcmp(command, "trace stop") == 0) {
+    trace.stop();
+  } else if (strcmp(command, "trace dump") == 0) {
+    trace.dump();
+  } else if (strcmp(command, "trace") == 0) {
+    trace.printStatus();
+  } else {
+    Serial.println("Commands: stats, tasks, capture [start|stop|dump], trace [start|stop|dump]");
+  }
+}
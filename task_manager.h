@@ -4,19 +4,29 @@
 
 #include "config.h"
 
+// A task created by the TaskManager, as configured
+struct TaskInfo {
+  TaskHandle_t handle;
+  uint32_t stackSize;
+  BaseType_t core;
+};
+
 class TaskManager {
 private:
   TaskHandle_t udpTaskHandle;
   TaskHandle_t displayTaskHandle;
   TaskHandle_t monitorTaskHandle;
+  TaskHandle_t logTaskHandle;
   
   TaskManager() : udpTaskHandle(nullptr), displayTaskHandle(nullptr), 
-                 monitorTaskHandle(nullptr) {}
+                 monitorTaskHandle(nullptr), logTaskHandle(nullptr) {}
   
   // Static task functions
   static void highSpeedUdpTask(void *pvParameters);
+  static void receiveImpaired(uint8_t* datagram, int maxSize, uint32_t lastTimeoutCheck);
   static void highSpeedDisplayTask(void *pvParameters);
   static void monitorTask(void *pvParameters);
+  static void logTask(void *pvParameters);
   
 public:
   static TaskManager& getInstance() {
@@ -27,6 +37,9 @@ public:
   bool initialize();
   void cleanup();
   
+  // The tasks created so far, for the performance monitor; returns their number
+  uint8_t getTasks(TaskInfo* tasks, uint8_t maxTasks) const;
+  
   ~TaskManager() { cleanup(); }
 };
 
@@ -38,20 +51,31 @@ public:
 #include "frame_processor.h"
 #include "display_manager.h"
 #include "performance_monitor.h"
+#include "network_impairment.h"
+#include "serial_console.h"
+#include "trace_recorder.h"
+#include "async_logger.h"
 
 bool TaskManager::initialize() {
   Serial.println("Creating high-speed tasks...");
   
   BaseType_t result1 = xTaskCreatePinnedToCore(
-    highSpeedUdpTask, "High-Speed UDP", 3072, NULL, 7, &udpTaskHandle, 0);
+    highSpeedUdpTask, "High-Speed UDP", Config::UDP_TASK_STACK, NULL, 7, &udpTaskHandle, 
+    Config::UDP_TASK_CORE);
   
   BaseType_t result2 = xTaskCreatePinnedToCore(
-    highSpeedDisplayTask, "High-Speed Display", 4096, NULL, 6, &displayTaskHandle, 1);
+    highSpeedDisplayTask, "High-Speed Display", Config::DISPLAY_TASK_STACK, NULL, 6, 
+    &displayTaskHandle, Config::DISPLAY_TASK_CORE);
   
   BaseType_t result3 = xTaskCreatePinnedToCore(
-    monitorTask, "Monitor", 2048, NULL, 1, &monitorTaskHandle, 0);
+    monitorTask, "Monitor", Config::MONITOR_TASK_STACK, NULL, 1, &monitorTaskHandle, 
+    Config::MONITOR_TASK_CORE);
   
-  if (result1 != pdPASS || result2 != pdPASS || result3 != pdPASS) {
+  // Serial output of the hot paths, in the display core's idle time
+  BaseType_t result4 = xTaskCreatePinnedToCore(
+    logTask, "Log", Config::LOG_TASK_STACK, NULL, 1, &logTaskHandle, Config::LOG_TASK_CORE);
+  
+  if (result1 != pdPASS || result2 != pdPASS || result3 != pdPASS || result4 != pdPASS) {
     Serial.println("FATAL: Failed to create tasks");
     return false;
   }
@@ -64,28 +88,117 @@ void TaskManager::cleanup() {
   if (udpTaskHandle) { vTaskDelete(udpTaskHandle); udpTaskHandle = nullptr; }
   if (displayTaskHandle) { vTaskDelete(displayTaskHandle); displayTaskHandle = nullptr; }
   if (monitorTaskHandle) { vTaskDelete(monitorTaskHandle); monitorTaskHandle = nullptr; }
+  if (logTaskHandle) { vTaskDelete(logTaskHandle); logTaskHandle = nullptr; }
+}
+
+uint8_t TaskManager::getTasks(TaskInfo* tasks, uint8_t maxTasks) const {
+  const TaskInfo all[] = {
+    { udpTaskHandle, Config::UDP_TASK_STACK, Config::UDP_TASK_CORE },
+    { displayTaskHandle, Config::DISPLAY_TASK_STACK, Config::DISPLAY_TASK_CORE },
+    { monitorTaskHandle, Config::MONITOR_TASK_STACK, Config::MONITOR_TASK_CORE },
+    { logTaskHandle, Config::LOG_TASK_STACK, Config::LOG_TASK_CORE }
+  };
+  uint8_t count = 0;
+  for (const TaskInfo& task : all) {
+    if (task.handle && count < maxTasks) tasks[count++] = task;
+  }
+  return count;
 }
 
 void TaskManager::highSpeedUdpTask(void *pvParameters) {
-  const TickType_t xDelay = pdMS_TO_TICKS(1);
-  uint8_t packetBuffer[1500];
+  uint8_t header[WireProto::MAX_HEADER_SIZE];
+  uint8_t request[WireProto::NACK_MAX_SIZE];
+  uint32_t lastTimeoutCheck = millis();
   
   NetworkManager& nm = NetworkManager::getInstance();
   FrameProcessor& fp = FrameProcessor::getInstance();
+  NetworkImpairment& impairment = NetworkImpairment::getInstance();
+  
+  // Impaired datagrams need a copy; the zero-copy path has nowhere to hold them
+  static uint8_t datagram[WireProto::MAX_HEADER_SIZE + WireProto::PARITY_PAYLOAD_SIZE];
   
   while(1) {
-    // Process multiple packets per cycle for higher throughput
-    for (int i = 0; i < 3; i++) {
-      int bytesRead = nm.readPacket(packetBuffer, sizeof(packetBuffer));
-      if (bytesRead > 0) {
-        fp.processPacket(packetBuffer, bytesRead);
-      } else {
-        break; // No more packets, exit loop
+    if (impairment.isActive()) {
+      receiveImpaired(datagram, sizeof(datagram), lastTimeoutCheck);
+    } else {
+      // Sleep in the socket until traffic arrives, then drain the whole queue,
+      // stopping when the timeout sweep is due so a queue that never empties
+      // cannot hold it off
+      bool wait = true;
+      int headerBytes;
+      while (millis() - lastTimeoutCheck < Config::FRAME_TIMEOUT_CHECK_INTERVAL &&
+             (headerBytes = nm.peekPacketHeader(header, sizeof(header), wait)) >= 0) {
+        wait = false;
+        TraceScope trace(TraceRecorder::TRACE_PACKET);
+        
+        // Empty, short and foreign datagrams fail here, before any frame state is
+        // touched, and are consumed so the queue moves on
+        WireProto::PacketHeader packet;
+        PacketPlacement placement;
+        uint8_t* destination = nullptr;
+        if (WireProto::parseHeader(header, headerBytes, packet, Config::ACCEPT_V1_PACKETS)) {
+          trace.setFrame(packet.frameId);
+          destination = fp.reservePayload(packet, placement);
+        }
+        
+        if (!destination) {
+          nm.skipPacket();
+          continue;
+        }
+        
+        // Header and payload land in one scatter read, payload straight into its slot
+        int expected = packet.headerSize + placement.payloadSize;
+        if (nm.receivePacket(header, packet.headerSize, destination, placement.payloadSize) == expected) {
+          fp.commitPayload(placement);
+        }
       }
     }
     
-    fp.handleFrameTimeout();
-    vTaskDelay(xDelay);
+    // The socket timeout bounds how late a frame timeout can be noticed when idle
+    uint32_t now = millis();
+    if (now - lastTimeoutCheck >= Config::FRAME_TIMEOUT_CHECK_INTERVAL) {
+      fp.handleFrameTimeout();
+      
+      // Ask the camera again for packets that can still make their frame
+      int requestSize;
+      while ((requestSize = fp.buildRetransmitRequest(request, sizeof(request))) > 0) {
+        nm.sendToCamera(request, requestSize);
+      }
+      
+      lastTimeoutCheck = now;
+    }
+  }
+}
+
+void TaskManager::receiveImpaired(uint8_t* datagram, int maxSize, uint32_t lastTimeoutCheck) {
+  NetworkManager& nm = NetworkManager::getInstance();
+  FrameProcessor& fp = FrameProcessor::getInstance();
+  NetworkImpairment& impairment = NetworkImpairment::getInstance();
+  
+  // Only sleep in the socket when nothing is held back for later, and leave
+  // the rest of the queue for the next pass once the timeout sweep is due
+  bool wait = !impairment.hasPending();
+  int peeked;
+  while (millis() - lastTimeoutCheck < Config::FRAME_TIMEOUT_CHECK_INTERVAL &&
+         (peeked = nm.peekPacketHeader(datagram, 1, wait)) >= 0) {
+    wait = false;
+    if (peeked == 0) {
+      nm.skipPacket();   // Empty datagram: consume it or the peek returns it forever
+      continue;
+    }
+    int size = nm.readPacket(datagram, maxSize);
+    if (size > 0) {
+      impairment.submit(datagram, size, micros());
+    }
+  }
+  
+  int size;
+  while ((size = impairment.release(datagram, maxSize, micros())) > 0) {
+    fp.processPacket(datagram, size);
+  }
+  
+  if (impairment.hasPending()) {
+    vTaskDelay(1);
   }
 }
 
@@ -122,7 +235,10 @@ void TaskManager::highSpeedDisplayTask(void *pvParameters) {
         if (fp.assembleCompleteFrame()) {
           // High-speed frame rendering
           CompleteFrameState& currentFrame = fp.getCurrentFrame();
-          if (dm.renderFrameHighSpeed(fp.getFrameBuffer(), currentFrame.totalSize)) {
+          pm.recordLatency(PerformanceMonitor::LATENCY_QUEUE, micros() - currentFrame.completeUs);
+          
+          if (dm.renderFrameHighSpeed(fp.getFrameBuffer(), currentFrame.totalSize, currentFrame.frameId)) {
+            pm.recordLatency(PerformanceMonitor::LATENCY_END_TO_END, micros() - currentFrame.firstPacketUs);
             lastRenderTime = currentTime;
             frameCount++;
             pm.incrementRenderedFrames();
@@ -144,11 +260,48 @@ void TaskManager::highSpeedDisplayTask(void *pvParameters) {
 }
 
 void TaskManager::monitorTask(void *pvParameters) {
-  const TickType_t xDelay = pdMS_TO_TICKS(3000);
+  const TickType_t xDelay = pdMS_TO_TICKS(100);
+  const uint32_t statisticsInterval = 3000;
+  uint32_t lastStatistics = millis();
+  uint32_t lastTaskSample = millis();
+  uint32_t lastTelemetry = millis();
+  uint8_t report[WireProto::TELEMETRY_MAX_SIZE];
+  
   PerformanceMonitor& pm = PerformanceMonitor::getInstance();
+  NetworkManager& nm = NetworkManager::getInstance();
+  SerialConsole& console = SerialConsole::getInstance();
+  
+  while(1) {
+    console.poll();
+    
+    uint32_t now = millis();
+    if (now - lastTaskSample >= Config::TASK_SAMPLE_INTERVAL) {
+      pm.sampleTasks();
+      lastTaskSample = now;
+    }
+    
+    if (Config::TELEMETRY_ENABLED && now - lastTelemetry >= Config::TELEMETRY_INTERVAL) {
+      nm.sendTelemetry(report, pm.buildTelemetry(report, sizeof(report)));
+      lastTelemetry = now;
+    }
+    
+    // Text statistics are the fallback when there is no telemetry
+    bool printStatistics = Config::SERIAL_STATISTICS || !Config::TELEMETRY_ENABLED;
+    if (printStatistics && now - lastStatistics >= statisticsInterval) {
+      pm.printStatistics();
+      lastStatistics = now;
+    }
+    
+    vTaskDelay(xDelay);
+  }
+}
+
+void TaskManager::logTask(void *pvParameters) {
+  const TickType_t xDelay = pdMS_TO_TICKS(Config::LOG_DRAIN_INTERVAL);
+  AsyncLogger& logger = AsyncLogger::getInstance();
   
   while(1) {
-    pm.printStatistics();
+    logger.drain();
     vTaskDelay(xDelay);
   }
 }
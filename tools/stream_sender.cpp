@@ -0,0 +1,313 @@
+// stream_sender.cpp
+// Linux stand-in for the ESP32-CAM: streams JPEG frames to the display over UDP
+// with the same packetization as sendFrameToWROOM() in rtos_camfeed.ino, but at
+// any rate, so the receive path can be load-tested beyond the camera's 5 fps.
+//
+//   stream_sender [options]
+//     --host ADDR        Display address (default 127.0.0.1)
+//     --port N           Display UDP port (default 4210)
+//     --dir PATH         Send the *.jpg files in PATH, in name order, looping
+//     --size BYTES       Generated frame size when no --dir (default 20000)
+//     --width N          Generated frame width in the SOF marker (default 320)
+//     --height N         Generated frame height in the SOF marker (default 240)
+//     --fps N            Frames per second, 0 = as fast as possible (default 5)
+//     --frames N         Frames to send, 0 = until interrupted (default 100)
+//     --pace-us N        Delay after each burst of packets (default 1000, as the camera)
+//     --burst N          Packets sent back to back per burst (default 1)
+//     --wire N           Header version 1 or 2 (default 2)
+//     --fec N            Parity packet per N data packets, 0 = off (default 0)
+//     --no-nack          Ignore retransmit requests
+//     --quiet            Only print the summary
+#include "stream_source.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+struct SenderOptions {
+  const char* host = "127.0.0.1";
+  int port = 4210;
+  const char* dir = nullptr;
+  uint32_t size = 20000;
+  uint16_t width = 320;
+  uint16_t height = 240;
+  double fps = 5;
+  uint32_t frames = 100;
+  uint32_t paceUs = 1000;
+  uint32_t burst = 1;
+  uint8_t wire = 2;
+  uint8_t fecGroupSize = 0;
+  bool answerNacks = true;
+  bool quiet = false;
+};
+
+struct SentFrame {
+  uint32_t frameId;
+  uint32_t captureTimeUs;
+  std::vector<uint8_t> data;
+};
+
+struct SenderStats {
+  uint32_t frames = 0;
+  uint64_t packets = 0;
+  uint64_t parityPackets = 0;
+  uint64_t bytes = 0;
+  uint32_t sendErrors = 0;
+  uint32_t nacks = 0;
+  uint64_t retransmits = 0;
+};
+
+static const int HISTORY_FRAMES = 2;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) { stopRequested = 1; }
+
+static uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void sleepUntilUs(uint64_t deadline) {
+  struct timespec ts;
+  ts.tv_sec = deadline / 1000000ULL;
+  ts.tv_nsec = (deadline % 1000000ULL) * 1000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR && !stopRequested) {}
+}
+
+static bool loadDirectory(const char* path, std::vector<std::vector<uint8_t>>& frames) {
+  DIR* dir = opendir(path);
+  if (!dir) return false;
+  
+  std::vector<std::string> names;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower.size() > 4 && (lower.compare(lower.size() - 4, 4, ".jpg") == 0 ||
+                             lower.compare(lower.size() - 5, 5, ".jpeg") == 0)) {
+      names.push_back(std::string(path) + "/" + name);
+    }
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+  
+  for (const std::string& name : names) {
+    FILE* f = fopen(name.c_str(), "rb");
+    if (!f) continue;
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+    if (data.size() >= 4) frames.push_back(data);
+  }
+  return !frames.empty();
+}
+
+class StreamSender {
+public:
+  StreamSender(const SenderOptions& options) : opt(options), sock(-1) {}
+  ~StreamSender() { if (sock >= 0) close(sock); }
+  
+  bool open() {
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) return false;
+    
+    int sendBuffer = 1 << 20;
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+    
+    memset(&target, 0, sizeof(target));
+    target.sin_family = AF_INET;
+    target.sin_port = htons(opt.port);
+    return inet_pton(AF_INET, opt.host, &target.sin_addr) == 1;
+  }
+  
+  void sendFrame(uint32_t frameId, const std::vector<uint8_t>& frameData) {
+    WireProto::PacketHeader frame = StreamSource::frameHeader(frameId, frameData.size(), (uint32_t)nowUs());
+    
+    SentFrame& history = sentFrames[frameId % HISTORY_FRAMES];
+    history.frameId = frameId;
+    history.captureTimeUs = frame.captureTimeUs;
+    history.data = frameData;
+    
+    uint32_t inBurst = 0;
+    StreamSource::packetizeFrame(frame, frameData.data(), opt.wire, opt.fecGroupSize,
+                                 [&](const StreamSource::Packet& packet, bool isParity) {
+      sendPacket(packet);
+      if (isParity) {
+        stats.parityPackets++;
+        return;
+      }
+      
+      stats.packets++;
+      if (++inBurst >= opt.burst) {
+        inBurst = 0;
+        pace();
+      }
+    });
+    
+    stats.frames++;
+  }
+  
+  // Resends packets the display reported missing, from the recent-frame history
+  void serviceNacks() {
+    if (!opt.answerNacks) return;
+    
+    uint8_t request[WireProto::NACK_MAX_SIZE];
+    ssize_t n;
+    while ((n = recv(sock, request, sizeof(request), MSG_DONTWAIT)) > 0) {
+      StreamSource::RetransmitRequest nack;
+      if (!StreamSource::parseRequest(request, n, nack)) continue;
+      
+      SentFrame& history = sentFrames[nack.frameId % HISTORY_FRAMES];
+      if (history.frameId != nack.frameId || history.data.empty()) continue;
+      
+      WireProto::PacketHeader frame = StreamSource::frameHeader(nack.frameId, history.data.size(), history.captureTimeUs);
+      if (frame.totalPackets != nack.totalPackets) continue;
+      
+      stats.nacks++;
+      StreamSource::Packet packet;
+      StreamSource::forEachRequestedPacket(nack, [&](uint16_t index) {
+        StreamSource::buildDataPacket(packet, frame, history.data.data(), index, WireProto::FLAG_RETRANSMIT, opt.wire);
+        sendPacket(packet);
+        stats.retransmits++;
+      });
+    }
+  }
+  
+  const SenderStats& getStats() const { return stats; }
+
+private:
+  const SenderOptions& opt;
+  int sock;
+  struct sockaddr_in target;
+  SentFrame sentFrames[HISTORY_FRAMES];
+  SenderStats stats;
+  
+  void sendPacket(const StreamSource::Packet& packet) {
+    if (sendto(sock, packet.data(), packet.size(), 0, (struct sockaddr*)&target, sizeof(target)) == (ssize_t)packet.size()) {
+      stats.bytes += packet.size();
+    } else {
+      stats.sendErrors++;
+    }
+  }
+  
+  void pace() {
+    if (opt.paceUs > 0) {
+      sleepUntilUs(nowUs() + opt.paceUs);
+    }
+    serviceNacks();
+  }
+};
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [--host ADDR] [--port N] [--dir PATH | --size BYTES --width N --height N]\n"
+                  "       [--fps N] [--frames N] [--pace-us N] [--burst N] [--wire 1|2] [--fec N]\n"
+                  "       [--no-nack] [--quiet]\n", name);
+}
+
+static bool parseOptions(int argc, char** argv, SenderOptions& opt) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    
+    if (arg == "--no-nack") opt.answerNacks = false;
+    else if (arg == "--quiet") opt.quiet = true;
+    else if (!hasValue) return false;
+    else if (arg == "--host") opt.host = argv[++i];
+    else if (arg == "--port") opt.port = atoi(argv[++i]);
+    else if (arg == "--dir") opt.dir = argv[++i];
+    else if (arg == "--size") opt.size = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--width") opt.width = atoi(argv[++i]);
+    else if (arg == "--height") opt.height = atoi(argv[++i]);
+    else if (arg == "--fps") opt.fps = atof(argv[++i]);
+    else if (arg == "--frames") opt.frames = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--pace-us") opt.paceUs = strtoul(argv[++i], nullptr, 0);
+    else if (arg == "--burst") opt.burst = std::max(1, atoi(argv[++i]));
+    else if (arg == "--wire") opt.wire = atoi(argv[++i]);
+    else if (arg == "--fec") opt.fecGroupSize = atoi(argv[++i]);
+    else return false;
+  }
+  
+  return opt.wire == 1 || opt.wire == WireProto::VERSION;
+}
+
+int main(int argc, char** argv) {
+  SenderOptions opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage(argv[0]);
+    return 2;
+  }
+  
+  std::vector<std::vector<uint8_t>> files;
+  if (opt.dir && !loadDirectory(opt.dir, files)) {
+    fprintf(stderr, "No JPEG files in %s\n", opt.dir);
+    return 1;
+  }
+  
+  StreamSender sender(opt);
+  if (!sender.open()) {
+    fprintf(stderr, "Cannot open UDP socket to %s:%d\n", opt.host, opt.port);
+    return 1;
+  }
+  
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  
+  uint64_t interval = opt.fps > 0 ? (uint64_t)(1000000.0 / opt.fps) : 0;
+  uint64_t start = nowUs();
+  uint64_t nextFrame = start;
+  std::vector<uint8_t> generated;
+  
+  for (uint32_t frameId = 1; !stopRequested && (opt.frames == 0 || frameId <= opt.frames); frameId++) {
+    const std::vector<uint8_t>* frame = &generated;
+    if (!files.empty()) {
+      frame = &files[(frameId - 1) % files.size()];
+    } else {
+      StreamSource::generateFrame(generated, frameId, opt.size, opt.width, opt.height);
+    }
+    
+    sender.sendFrame(frameId, *frame);
+    
+    if (!opt.quiet && frameId % 100 == 0) {
+      printf("Frame %u: %zu bytes\n", frameId, frame->size());
+    }
+    
+    // Keep answering NACKs while waiting for the next frame slot
+    nextFrame += interval;
+    while (!stopRequested && nowUs() < nextFrame) {
+      sleepUntilUs(std::min<uint64_t>(nextFrame, nowUs() + 1000));
+      sender.serviceNacks();
+    }
+  }
+  
+  double seconds = (nowUs() - start) / 1e6;
+  
+  // Late NACKs for the final frames
+  uint64_t drainUntil = nowUs() + 200000;
+  while (!stopRequested && nowUs() < drainUntil) {
+    sleepUntilUs(nowUs() + 1000);
+    sender.serviceNacks();
+  }
+  
+  const SenderStats& stats = sender.getStats();
+  printf("Sent %u frames, %llu packets (+%llu parity) in %.2f s: %.1f fps, %.2f Mbit/s\n",
+         stats.frames, (unsigned long long)stats.packets, (unsigned long long)stats.parityPackets,
+         seconds, stats.frames / seconds, stats.bytes * 8 / seconds / 1e6);
+  printf("NACKs answered: %u, packets resent: %llu, send errors: %u\n",
+         stats.nacks, (unsigned long long)stats.retransmits, stats.sendErrors);
+  return 0;
+}
@@ -0,0 +1,159 @@
+// stream_source.h
+#ifndef STREAM_SOURCE_H
+#define STREAM_SOURCE_H
+
+#include "../wire_protocol.h"
+
+#include <algorithm>
+#include <vector>
+
+// Host-side camera model: synthetic frames and the packetization of
+// sendFrameToWROOM() in rtos_camfeed.ino (data packets in index order, a parity
+// packet closing every FEC group). Shared by the stream sender and the
+// in-process scenario runners.
+namespace StreamSource {
+  typedef std::vector<uint8_t> Packet;
+  
+  // Minimal baseline JPEG: SOI, SOF0 with the frame size, per-frame filler in COM
+  // segments, EOI. Enough for the receiver's validation and the host decoder
+  // shim; a real decoder needs real JPEGs.
+  inline void generateFrame(std::vector<uint8_t>& out, uint32_t frameId, uint32_t size,
+                            uint16_t width, uint16_t height) {
+    static const uint8_t sof[] = {
+      0xFF, 0xC0, 0x00, 0x11, 0x08, 0, 0, 0, 0, 0x03,
+      0x01, 0x21, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01
+    };
+    size = std::max<uint32_t>(size, sizeof(sof) + 8);
+    
+    out.clear();
+    out.reserve(size);
+    out.push_back(0xFF);
+    out.push_back(0xD8);
+    out.insert(out.end(), sof, sof + sizeof(sof));
+    out[2 + 5] = height >> 8;
+    out[2 + 6] = height & 0xFF;
+    out[2 + 7] = width >> 8;
+    out[2 + 8] = width & 0xFF;
+    
+    // Per-frame xorshift filler so consecutive frames differ
+    uint32_t state = frameId * 2654435761u + 1;
+    while (out.size() + 4 + 2 < size) {
+      uint32_t segment = std::min<uint32_t>(size - out.size() - 2 - 4, 65533);
+      out.push_back(0xFF);
+      out.push_back(0xFE);
+      out.push_back((segment + 2) >> 8);
+      out.push_back((segment + 2) & 0xFF);
+      for (uint32_t i = 0; i < segment; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        out.push_back(state & 0xFF);
+      }
+    }
+    
+    out.push_back(0xFF);
+    out.push_back(0xD9);
+  }
+  
+  // Header fields shared by every packet of a frame
+  inline WireProto::PacketHeader frameHeader(uint32_t frameId, uint32_t length, uint32_t captureTimeUs) {
+    WireProto::PacketHeader frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.frameId = frameId;
+    frame.frameLength = length;
+    frame.totalPackets = (length + WireProto::PAYLOAD_SIZE - 1) / WireProto::PAYLOAD_SIZE;
+    frame.captureTimeUs = captureTimeUs;
+    return frame;
+  }
+  
+  inline void buildPacket(Packet& packet, const WireProto::PacketHeader& header,
+                          const uint8_t* payload, uint8_t wire) {
+    packet.resize(WireProto::MAX_HEADER_SIZE + header.payloadLength);
+    int headerSize = WireProto::writeHeader(packet.data(), header, wire);
+    memcpy(packet.data() + headerSize, payload, header.payloadLength);
+    packet.resize(headerSize + header.payloadLength);
+  }
+  
+  inline void buildDataPacket(Packet& packet, const WireProto::PacketHeader& frame, const uint8_t* data,
+                              uint16_t index, uint8_t flags, uint8_t wire) {
+    WireProto::PacketHeader header = frame;
+    header.flags = flags;
+    header.packetIndex = index;
+    header.byteOffset = (uint32_t)index * WireProto::PAYLOAD_SIZE;
+    header.payloadLength = std::min<uint32_t>(WireProto::PAYLOAD_SIZE, frame.frameLength - header.byteOffset);
+    buildPacket(packet, header, data + header.byteOffset, wire);
+  }
+  
+  // Calls emit(const Packet&, bool isParity) for every packet of the frame, in send order
+  template <typename Emit>
+  void packetizeFrame(const WireProto::PacketHeader& frame, const uint8_t* data, uint8_t wire,
+                      uint8_t fecGroupSize, Emit emit) {
+    Packet packet;
+    uint8_t parity[WireProto::PARITY_PAYLOAD_SIZE];
+    uint16_t parityLength = 0;
+    memset(parity, 0, sizeof(parity));
+    
+    for (uint16_t index = 0; index < frame.totalPackets; index++) {
+      buildDataPacket(packet, frame, data, index, 0, wire);
+      emit(packet, false);
+      
+      if (fecGroupSize == 0) continue;
+      
+      uint32_t offset = (uint32_t)index * WireProto::PAYLOAD_SIZE;
+      uint32_t length = std::min<uint32_t>(WireProto::PAYLOAD_SIZE, frame.frameLength - offset);
+      WireProto::xorPayload(parity + WireProto::PARITY_HEADER_SIZE, data + offset, length);
+      parityLength ^= length;
+      
+      if ((index + 1) % fecGroupSize == 0 || index == frame.totalPackets - 1) {
+        uint16_t group = index / fecGroupSize;
+        parity[0] = fecGroupSize;
+        parity[1] = 0;
+        WireProto::store16(parity + 2, parityLength);
+        
+        WireProto::PacketHeader header = frame;
+        header.flags = WireProto::FLAG_PARITY;
+        header.packetIndex = frame.totalPackets + group;
+        header.byteOffset = (uint32_t)group * fecGroupSize * WireProto::PAYLOAD_SIZE;
+        header.payloadLength = WireProto::PARITY_PAYLOAD_SIZE;
+        buildPacket(packet, header, parity, wire);
+        emit(packet, true);
+        
+        memset(parity, 0, sizeof(parity));
+        parityLength = 0;
+      }
+    }
+  }
+  
+  struct RetransmitRequest {
+    uint32_t frameId;
+    uint16_t totalPackets;
+    uint16_t base;
+    uint16_t bitmapBytes;
+    const uint8_t* bitmap;
+  };
+  
+  // Returns false if the datagram is not a well-formed NACK
+  inline bool parseRequest(const uint8_t* data, int size, RetransmitRequest& request) {
+    if (size < WireProto::NACK_HEADER_SIZE || WireProto::load32(data) != WireProto::NACK_MAGIC) return false;
+    
+    request.frameId = WireProto::load32(data + 4);
+    request.totalPackets = WireProto::load16(data + 8);
+    request.base = WireProto::load16(data + 10);
+    request.bitmapBytes = WireProto::load16(data + 12);
+    request.bitmap = data + WireProto::NACK_HEADER_SIZE;
+    return WireProto::NACK_HEADER_SIZE + request.bitmapBytes <= size;
+  }
+  
+  // Calls resend(index) for every requested packet of the frame
+  template <typename Resend>
+  void forEachRequestedPacket(const RetransmitRequest& request, Resend resend) {
+    for (uint16_t bit = 0; bit < request.bitmapBytes * 8; bit++) {
+      if (!(request.bitmap[bit / 8] & (1 << (bit & 7)))) continue;
+      uint16_t index = request.base + bit;
+      if (index >= request.totalPackets) break;
+      resend(index);
+    }
+  }
+}
+
+#endif // STREAM_SOURCE_H
@@ -0,0 +1,252 @@
+// telemetry_collector.cpp
+// Listens for the display's binary telemetry reports and prints each one as
+// a CSV row (default) or a JSON line, with the sender's address, so any number
+// of displays on the AP network can be watched without serial cables.
+//
+//   telemetry_collector [options]
+//     --port N           UDP port to listen on (default 4211, Config::TELEMETRY_PORT)
+//     --json             One JSON object per report instead of CSV
+//     --count N          Exit after N reports (default: until interrupted)
+//
+// CSV columns follow the first report received; task columns are named after
+// the tasks it lists.
+#include "../wire_protocol.h"
+
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char* COUNTER_NAMES[] = {
+  "frames_started", "frames_complete", "frames_rendered",
+  "frames_incomplete", "frames_evicted", "frames_corrupt", "frames_skipped",
+  "packets_lost", "packets_recovered", "packets_rebuilt_early", "data_bytes", "parity_bytes",
+  "retransmit_requests", "packets_requested", "packets_retransmitted", "frames_repaired",
+  "memory_errors", "log_messages", "log_dropped", "clients",
+  "core0_idle_permille", "core1_idle_permille",
+  "strip_dma_busy_us", "strip_dma_wait_us",
+  "blocks_checked", "blocks_changed", "delta_bytes_saved"
+};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == WireProto::TELEMETRY_COUNTER_COUNT,
+              "one name per WireProto::TelemetryCounter");
+static const char* STAGE_NAMES[] = { "assembly", "queue", "decode", "transfer", "end_to_end" };
+static const char* STAGE_FIELDS[WireProto::TELEMETRY_STAGE_FIELDS] = { "count", "p50", "p90", "p99", "max" };
+
+struct TaskStats {
+  std::string name;
+  uint32_t stackFree;
+  uint32_t stackSize;
+  uint16_t cpuPermille; // WireProto::TELEMETRY_UNKNOWN when not reported
+  uint8_t core;
+};
+
+struct Report {
+  uint32_t sequence;
+  uint32_t uptimeMs;
+  uint32_t heapFree;
+  uint32_t heapMinFree;
+  uint16_t retransmitRtt;
+  uint8_t activeSlots;
+  std::vector<uint32_t> counters;
+  std::vector<uint32_t> stages;   // stage_count x TELEMETRY_STAGE_FIELDS
+  std::vector<TaskStats> tasks;
+};
+
+static bool decodeReport(const uint8_t* data, int size, Report& report) {
+  if (size < WireProto::TELEMETRY_HEADER_SIZE || WireProto::load32(data) != WireProto::TELEMETRY_MAGIC) return false;
+  
+  uint8_t headerSize = data[5];
+  uint8_t counterCount = data[6];
+  uint8_t stageCount = data[7];
+  uint8_t taskCount = data[8];
+  uint8_t taskEntrySize = data[9];
+  if (headerSize < WireProto::TELEMETRY_HEADER_SIZE || taskEntrySize < WireProto::TELEMETRY_TASK_NAME_SIZE + 4) return false;
+  int expected = headerSize + counterCount * 4 + stageCount * WireProto::TELEMETRY_STAGE_FIELDS * 4 +
+                 taskCount * taskEntrySize;
+  if (size < expected) return false;
+  
+  report.activeSlots = data[10];
+  report.sequence = WireProto::load32(data + 12);
+  report.uptimeMs = WireProto::load32(data + 16);
+  report.heapFree = WireProto::load32(data + 20);
+  report.heapMinFree = WireProto::load32(data + 24);
+  report.retransmitRtt = WireProto::load16(data + 28);
+  
+  // Counters this collector knows; newer ones are skipped, missing ones read 0
+  const uint8_t* in = data + headerSize;
+  report.counters.assign(WireProto::TELEMETRY_COUNTER_COUNT, 0);
+  for (uint8_t i = 0; i < counterCount; i++, in += 4) {
+    if (i < WireProto::TELEMETRY_COUNTER_COUNT) report.counters[i] = WireProto::load32(in);
+  }
+  
+  report.stages.clear();
+  for (int i = 0; i < stageCount * WireProto::TELEMETRY_STAGE_FIELDS; i++, in += 4) {
+    report.stages.push_back(WireProto::load32(in));
+  }
+  
+  report.tasks.clear();
+  for (uint8_t i = 0; i < taskCount; i++, in += taskEntrySize) {
+    TaskStats task;
+    task.name.assign((const char*)in, strnlen((const char*)in, WireProto::TELEMETRY_TASK_NAME_SIZE));
+    task.stackFree = WireProto::load32(in + WireProto::TELEMETRY_TASK_NAME_SIZE);
+    // Stack size, CPU and core came with the 28-byte entry
+    bool usage = taskEntrySize >= WireProto::TELEMETRY_TASK_NAME_SIZE + 12;
+    task.stackSize = usage ? WireProto::load32(in + WireProto::TELEMETRY_TASK_NAME_SIZE + 4) : 0;
+    task.cpuPermille = usage ? WireProto::load16(in + WireProto::TELEMETRY_TASK_NAME_SIZE + 8) : WireProto::TELEMETRY_UNKNOWN;
+    task.core = usage ? in[WireProto::TELEMETRY_TASK_NAME_SIZE + 10] : 0;
+    report.tasks.push_back(task);
+  }
+  return true;
+}
+
+static std::string stageName(size_t stage) {
+  return stage < sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) ? STAGE_NAMES[stage] : "stage" + std::to_string(stage);
+}
+
+// "High-Speed UDP" -> "high_speed_udp"
+static std::string columnName(const std::string& name) {
+  std::string column;
+  for (char c : name) column += isalnum((unsigned char)c) ? (char)tolower((unsigned char)c) : '_';
+  return column;
+}
+
+static void printCsvHeader(const Report& report) {
+  printf("time,source,sequence,uptime_ms,heap_free,heap_min_free,retransmit_rtt_ms,active_slots");
+  for (const char* name : COUNTER_NAMES) printf(",%s", name);
+  for (size_t stage = 0; stage < report.stages.size() / WireProto::TELEMETRY_STAGE_FIELDS; stage++) {
+    for (const char* field : STAGE_FIELDS) printf(",%s_%s_us", stageName(stage).c_str(), field);
+  }
+  for (const TaskStats& task : report.tasks) {
+    std::string column = columnName(task.name);
+    printf(",%s_core,%s_cpu_pct,%s_stack_free,%s_stack_size", column.c_str(), column.c_str(),
+           column.c_str(), column.c_str());
+  }
+  printf("\n");
+}
+
+static void printCsv(const Report& report, double now, const char* source) {
+  printf("%.3f,%s,%u,%u,%u,%u,%u,%u", now, source, report.sequence, report.uptimeMs,
+         report.heapFree, report.heapMinFree, report.retransmitRtt, report.activeSlots);
+  for (uint32_t value : report.counters) printf(",%u", value);
+  for (uint32_t value : report.stages) printf(",%u", value);
+  for (const TaskStats& task : report.tasks) {
+    printf(",%u,", task.core);
+    if (task.cpuPermille != WireProto::TELEMETRY_UNKNOWN) printf("%.1f", task.cpuPermille / 10.0);
+    printf(",%u,%u", task.stackFree, task.stackSize);
+  }
+  printf("\n");
+}
+
+static void printJson(const Report& report, double now, const char* source) {
+  printf("{\"time\":%.3f,\"source\":\"%s\",\"sequence\":%u,\"uptime_ms\":%u,\"heap_free\":%u,"
+         "\"heap_min_free\":%u,\"retransmit_rtt_ms\":%u,\"active_slots\":%u,\"counters\":{",
+         now, source, report.sequence, report.uptimeMs, report.heapFree, report.heapMinFree,
+         report.retransmitRtt, report.activeSlots);
+  for (int i = 0; i < WireProto::TELEMETRY_COUNTER_COUNT; i++) {
+    printf("%s\"%s\":%u", i ? "," : "", COUNTER_NAMES[i], report.counters[i]);
+  }
+  printf("},\"latency_us\":{");
+  for (size_t stage = 0; stage < report.stages.size() / WireProto::TELEMETRY_STAGE_FIELDS; stage++) {
+    printf("%s\"%s\":{", stage ? "," : "", stageName(stage).c_str());
+    for (int field = 0; field < WireProto::TELEMETRY_STAGE_FIELDS; field++) {
+      printf("%s\"%s\":%u", field ? "," : "", STAGE_FIELDS[field],
+             report.stages[stage * WireProto::TELEMETRY_STAGE_FIELDS + field]);
+    }
+    printf("}");
+  }
+  printf("},\"tasks\":[");
+  for (size_t i = 0; i < report.tasks.size(); i++) {
+    const TaskStats& task = report.tasks[i];
+    printf("%s{\"name\":\"%s\",\"core\":%u,\"stack_free\":%u,\"stack_size\":%u", i ? "," : "",
+           task.name.c_str(), task.core, task.stackFree, task.stackSize);
+    if (task.cpuPermille != WireProto::TELEMETRY_UNKNOWN) printf(",\"cpu_pct\":%.1f", task.cpuPermille / 10.0);
+    printf("}");
+  }
+  printf("]}\n");
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [--port N] [--json] [--count N]\n", name);
+}
+
+int main(int argc, char** argv) {
+  int port = 4211;
+  bool json = false;
+  long count = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--port" && i + 1 < argc) port = atoi(argv[++i]);
+    else if (arg == "--json") json = true;
+    else if (arg == "--count" && i + 1 < argc) count = atol(argv[++i]);
+    else { usage(argv[0]); return 2; }
+  }
+  
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  int reuse = 1;
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (sock < 0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    fprintf(stderr, "Cannot listen on UDP port %d\n", port);
+    return 1;
+  }
+  fprintf(stderr, "Listening for telemetry on UDP port %d\n", port);
+  
+  uint8_t datagram[2048];
+  bool headerPrinted = false;
+  std::vector<std::pair<uint32_t, uint32_t>> lastSequence;   // Source address -> sequence
+  for (long received = 0; count == 0 || received < count; ) {
+    struct sockaddr_in source;
+    socklen_t sourceLength = sizeof(source);
+    int size = recvfrom(sock, datagram, sizeof(datagram), 0, (struct sockaddr*)&source, &sourceLength);
+    if (size <= 0) continue;
+    
+    Report report;
+    if (!decodeReport(datagram, size, report)) {
+      fprintf(stderr, "Ignoring %d-byte datagram that is not a telemetry report\n", size);
+      continue;
+    }
+    received++;
+    
+    // Reports are fire-and-forget UDP: say when some went missing
+    uint32_t address = source.sin_addr.s_addr;
+    bool known = false;
+    for (auto& entry : lastSequence) {
+      if (entry.first != address) continue;
+      known = true;
+      if (report.sequence > entry.second + 1) {
+        fprintf(stderr, "%s: %u reports lost\n", inet_ntoa(source.sin_addr), report.sequence - entry.second - 1);
+      }
+      entry.second = report.sequence;
+    }
+    if (!known) lastSequence.push_back(std::make_pair(address, report.sequence));
+    
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    double now = ts.tv_sec + ts.tv_nsec / 1e9;
+    
+    if (json) {
+      printJson(report, now, inet_ntoa(source.sin_addr));
+    } else {
+      if (!headerPrinted) {
+        printCsvHeader(report);
+        headerPrinted = true;
+      }
+      printCsv(report, now, inet_ntoa(source.sin_addr));
+    }
+    fflush(stdout);
+  }
+  
+  close(sock);
+  return 0;
+}
@@ -0,0 +1,128 @@
+// trace_to_chrome.cpp
+// Converts a "trace dump" from the display (serial log, or capture_replay
+// --trace output) into Chrome trace JSON, for chrome://tracing or
+// ui.perfetto.dev. Each core is one track, each span one complete event with
+// its frame id, so the UDP task on core 0 and the decoder on core 1 line up
+// on the same time axis.
+//
+//   trace_to_chrome [options] [LOG]
+//     -o FILE            Write the JSON to FILE (default stdout)
+//
+// LOG defaults to stdin. When it holds several dumps, the last one is used.
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Span {
+  uint32_t startUs;
+  uint32_t durationUs;
+  int core;
+  std::string name;
+  uint32_t frameId;
+};
+
+static bool readDump(FILE* in, std::vector<Span>& spans) {
+  char line[256];
+  bool inDump = false;
+  bool found = false;
+  while (fgets(line, sizeof(line), in)) {
+    if (strncmp(line, "TRACE BEGIN", 11) == 0) {
+      spans.clear();
+      inDump = true;
+      found = true;
+      continue;
+    }
+    if (strncmp(line, "TRACE END", 9) == 0) {
+      inDump = false;
+      continue;
+    }
+    if (!inDump) continue;
+    
+    // Other tasks may print in the middle of a dump; skip what does not parse
+    Span span;
+    char name[64];
+    if (sscanf(line, "%u %u %d %63s %u", &span.startUs, &span.durationUs, &span.core, name, &span.frameId) != 5) {
+      continue;
+    }
+    span.name = name;
+    spans.push_back(span);
+  }
+  return found;
+}
+
+static void writeJson(FILE* out, const std::vector<Span>& spans) {
+  // micros() wraps every 71 minutes: place spans relative to the first one
+  // recorded, then shift so the earliest starts at zero
+  uint32_t base = spans.front().startUs;
+  int64_t earliest = 0;
+  for (const Span& span : spans) earliest = std::min(earliest, (int64_t)(int32_t)(span.startUs - base));
+  
+  std::vector<int> cores;
+  for (const Span& span : spans) {
+    if (std::find(cores.begin(), cores.end(), span.core) == cores.end()) cores.push_back(span.core);
+  }
+  std::sort(cores.begin(), cores.end());
+  
+  fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"camera-wroom-display\"}}");
+  for (int core : cores) {
+    const char* tasks = core == 0 ? " (UDP, monitor)" : core == 1 ? " (display)" : "";
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Core %d%s\"}}",
+            core, core, tasks);
+  }
+  for (const Span& span : spans) {
+    int64_t ts = (int64_t)(int32_t)(span.startUs - base) - earliest;
+    fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%u,\"args\":{\"frame\":%u}}",
+            span.name.c_str(), span.core, (long long)ts, span.durationUs, span.frameId);
+  }
+  fprintf(out, "\n]}\n");
+}
+
+static void usage(const char* name) {
+  fprintf(stderr, "usage: %s [-o FILE] [LOG]\n", name);
+}
+
+int main(int argc, char** argv) {
+  const char* inputPath = nullptr;
+  const char* outputPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) outputPath = argv[++i];
+    else if ((arg[0] != '-' || arg == "-") && !inputPath) inputPath = argv[i];
+    else { usage(argv[0]); return 2; }
+  }
+  
+  FILE* in = stdin;
+  if (inputPath && strcmp(inputPath, "-") != 0) {
+    in = fopen(inputPath, "r");
+    if (!in) {
+      fprintf(stderr, "Cannot read %s\n", inputPath);
+      return 1;
+    }
+  }
+  
+  std::vector<Span> spans;
+  bool found = readDump(in, spans);
+  if (in != stdin) fclose(in);
+  if (!found || spans.empty()) {
+    fprintf(stderr, "%s: no trace dump (TRACE BEGIN ... TRACE END)\n", inputPath ? inputPath : "stdin");
+    return 1;
+  }
+  
+  FILE* out = stdout;
+  if (outputPath) {
+    out = fopen(outputPath, "w");
+    if (!out) {
+      fprintf(stderr, "Cannot write %s\n", outputPath);
+      return 1;
+    }
+  }
+  writeJson(out, spans);
+  if (out != stdout) fclose(out);
+  
+  fprintf(stderr, "%zu spans converted\n", spans.size());
+  return 0;
+}
@@ -0,0 +1,157 @@
+// trace_recorder.h
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include "config.h"
+#include <atomic>
+
+// One timed span: begin and end time of a hot spot, with the core it ran on
+// and the frame it worked for (0 when unknown)
+struct TraceEvent {
+  uint32_t startUs;
+  uint32_t durationUs;
+  uint32_t frameId;
+  uint8_t type;
+  uint8_t core;
+};
+
+// Fixed ring of the newest TRACE_EVENT_COUNT spans. Recording is one relaxed
+// atomic increment and a 16-byte store, from any task on either core, and a
+// single flag test while tracing is off. "trace dump" prints the ring as text
+// for tools/trace_to_chrome, which turns it into Chrome/Perfetto trace JSON.
+class TraceRecorder {
+public:
+  enum EventType : uint8_t {
+    TRACE_PACKET,             // Datagram read and placed (UDP task)
+    TRACE_ASSEMBLE,           // Frame taken from the mailbox and validated
+    TRACE_DECODE,             // TJpgDec.drawJpg, including its output callbacks
+    TRACE_OUTPUT_BLOCK,       // One decoder output callback (TRACE_OUTPUT_BLOCKS)
+    TRACE_STRIP_TRANSFER,     // One MCU row strip pushed to the panel
+    TRACE_DISPLAY_LOCK_WAIT,  // Waiting for the display mutex
+    TRACE_EVENT_TYPES
+  };
+  
+  static TraceRecorder& getInstance() {
+    static TraceRecorder instance;
+    return instance;
+  }
+  
+  bool start();
+  void stop();
+  bool isActive() const { return active; }
+  
+  void record(uint8_t type, uint32_t startUs, uint32_t frameId) {
+    if (!active) return;
+    uint32_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = ring[index & (Config::TRACE_EVENT_COUNT - 1)];
+    event.startUs = startUs;
+    event.durationUs = micros() - startUs;
+    event.frameId = frameId;
+    event.type = type;
+    event.core = (uint8_t)xPortGetCoreID();
+  }
+  
+  // Prints the ring oldest first between TRACE BEGIN / TRACE END lines,
+  // pausing the recording meanwhile
+  void dump();
+  void printStatus() const;
+  
+  static const char* eventName(uint8_t type);
+  
+private:
+  TraceEvent* ring;
+  std::atomic<uint32_t> writeIndex;
+  volatile bool active;
+  
+  TraceRecorder() : ring(nullptr), writeIndex(0), active(false) {}
+};
+
+// Records the enclosing scope as one span; costs a flag test when tracing is off
+class TraceScope {
+public:
+  TraceScope(uint8_t type, uint32_t frameId = 0)
+    : type(type), frameId(frameId), timed(TraceRecorder::getInstance().isActive()),
+      startUs(timed ? micros() : 0) {}
+  
+  ~TraceScope() {
+    if (timed) TraceRecorder::getInstance().record(type, startUs, frameId);
+  }
+  
+  void setFrame(uint32_t id) { frameId = id; }
+  
+private:
+  uint8_t type;
+  uint32_t frameId;
+  bool timed;
+  uint32_t startUs;
+};
+
+#endif // TRACE_RECORDER_H
+
+// trace_recorder.cpp
+#include "trace_recorder.h"
+
+static_assert((Config::TRACE_EVENT_COUNT & (Config::TRACE_EVENT_COUNT - 1)) == 0,
+              "TRACE_EVENT_COUNT must be a power of two");
+
+bool TraceRecorder::start() {
+  if (active) return true;
+  
+  if (!ring) {
+    ring = (TraceEvent*)heap_caps_malloc(Config::TRACE_EVENT_COUNT * sizeof(TraceEvent), MALLOC_CAP_8BIT);
+    if (!ring) {
+      Serial.println("Trace: no buffer");
+      return false;
+    }
+  }
+  
+  writeIndex.store(0, std::memory_order_relaxed);
+  active = true;
+  Serial.printf("Trace started (%d events)\n", Config::TRACE_EVENT_COUNT);
+  return true;
+}
+
+void TraceRecorder::stop() {
+  if (!active) return;
+  active = false;
+  Serial.printf("Trace stopped: %d events\n", writeIndex.load(std::memory_order_relaxed));
+}
+
+const char* TraceRecorder::eventName(uint8_t type) {
+  static const char* names[TRACE_EVENT_TYPES] = {
+    "packet", "assemble", "jpeg_decode", "output_block", "strip_transfer", "display_lock_wait"
+  };
+  return type < TRACE_EVENT_TYPES ? names[type] : "unknown";
+}
+
+void TraceRecorder::dump() {
+  if (!ring) {
+    printStatus();
+    return;
+  }
+  
+  // Let spans already past the flag test land before reading the ring
+  bool wasActive = active;
+  active = false;
+  vTaskDelay(1);
+  
+  uint32_t written = writeIndex.load(std::memory_order_relaxed);
+  uint32_t count = min(written, (uint32_t)Config::TRACE_EVENT_COUNT);
+  
+  // One line per span: start_us duration_us core name frame
+  Serial.printf("TRACE BEGIN events=%d\n", count);
+  for (uint32_t i = written - count; i != written; i++) {
+    const TraceEvent& event = ring[i & (Config::TRACE_EVENT_COUNT - 1)];
+    Serial.printf("%u %u %d %s %u\n", event.startUs, event.durationUs, event.core,
+                 eventName(event.type), event.frameId);
+  }
+  Serial.println("TRACE END");
+  
+  active = wasActive;
+}
+
+void TraceRecorder::printStatus() const {
+  uint32_t written = writeIndex.load(std::memory_order_relaxed);
+  Serial.printf("Trace: %s, Events=%d, Kept=%d\n", active ? "on" : "off", written,
+               min(written, (uint32_t)Config::TRACE_EVENT_COUNT));
+}
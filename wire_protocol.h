@@ -0,0 +1,199 @@
+// wire_protocol.h
+#ifndef WIRE_PROTOCOL_H
+#define WIRE_PROTOCOL_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Camera -> display packet format, shared by rtos_camfeed.ino and the display
+// firmware. All multi-byte fields are little-endian and read a byte at a time,
+// so headers can sit at any alignment.
+//
+// v2 header (32 bytes):
+//   0  magic u32          4  version u8        5  flags u8
+//   6  header_size u8     7  reserved u8       8  frame_seq u32
+//   12 frame_length u32   16 byte_offset u32   20 packet_index u16
+//   22 total_packets u16  24 payload_length u16 26 reserved u16
+//   28 capture_time_us u32
+//
+// v1 header (12 bytes, no magic):
+//   0  frame_id u32       4  total_packets u16 6  packet_index u16
+//   8  packet_size u32
+namespace WireProto {
+  constexpr uint32_t MAGIC = 0x4D414357;       // "WCAM"
+  constexpr uint8_t VERSION = 2;
+  constexpr uint8_t V1_HEADER_SIZE = 12;
+  constexpr uint8_t V2_HEADER_SIZE = 32;
+  constexpr uint8_t MAX_HEADER_SIZE = V2_HEADER_SIZE;
+  
+  // Every data packet but the last carries exactly this much of the frame
+  constexpr uint16_t PAYLOAD_SIZE = 1388;
+  
+  enum PacketFlags : uint8_t {
+    FLAG_PARITY = 0x01,       // XOR parity packet, index = total_packets + group
+    FLAG_RETRANSMIT = 0x02    // Resent in answer to a NACK
+  };
+  
+  // Parity payload: [group_size u8][reserved u8][xor_length u16][xor data]
+  constexpr uint8_t PARITY_HEADER_SIZE = 4;
+  constexpr uint16_t PARITY_PAYLOAD_SIZE = PARITY_HEADER_SIZE + PAYLOAD_SIZE;
+  
+  // NACK (display -> camera):
+  // [magic u32][frame_id u32][total_packets u16][base u16][bitmap_bytes u16][bitmap]
+  // Bit i of the bitmap asks for packet base + i.
+  constexpr uint32_t NACK_MAGIC = 0x4B43414E;  // "NACK"
+  constexpr uint8_t NACK_HEADER_SIZE = 14;
+  constexpr uint8_t NACK_MAX_BITMAP_BYTES = 64;
+  constexpr uint8_t NACK_MAX_SIZE = NACK_HEADER_SIZE + NACK_MAX_BITMAP_BYTES;
+  
+  // Telemetry (display -> collector), one datagram per report:
+  //   header (32 bytes):
+  //     0  magic u32            4  version u8          5  header_size u8
+  //     6  counter_count u8     7  stage_count u8      8  task_count u8
+  //     9  task_entry_size u8   10 active_slots u8     11 reserved u8
+  //     12 sequence u32         16 uptime_ms u32       20 heap_free u32
+  //     24 heap_min_free u32    28 retransmit_rtt_ms u16 30 reserved u16
+  //   counters: counter_count x u32, in TelemetryCounter order
+  //   latency:  stage_count x (count, p50, p90, p99, max) u32, microseconds
+  //   tasks:    task_count x task_entry_size: name char[16] (NUL padded), stack_free u32,
+  //             stack_size u32, cpu_permille u16, core u8, reserved u8
+  // Percentages are per mille of one core over the last sample interval,
+  // TELEMETRY_UNKNOWN when the firmware has no FreeRTOS run-time stats.
+  // Readers use the counts and sizes, so later versions may append fields.
+  constexpr uint32_t TELEMETRY_MAGIC = 0x4D4C5457;  // "WTLM"
+  constexpr uint8_t TELEMETRY_VERSION = 1;
+  constexpr uint8_t TELEMETRY_HEADER_SIZE = 32;
+  constexpr uint8_t TELEMETRY_STAGE_FIELDS = 5;
+  constexpr uint8_t TELEMETRY_TASK_NAME_SIZE = 16;
+  constexpr uint8_t TELEMETRY_TASK_ENTRY_SIZE = TELEMETRY_TASK_NAME_SIZE + 12;
+  constexpr uint8_t TELEMETRY_MAX_STAGES = 8;
+  constexpr uint8_t TELEMETRY_MAX_TASKS = 8;
+  constexpr uint16_t TELEMETRY_UNKNOWN = 0xFFFF;
+  
+  enum TelemetryCounter : uint8_t {
+    TM_FRAMES_STARTED, TM_FRAMES_COMPLETE, TM_FRAMES_RENDERED,
+    TM_FRAMES_INCOMPLETE, TM_FRAMES_EVICTED, TM_FRAMES_CORRUPT, TM_FRAMES_SKIPPED,
+    TM_PACKETS_LOST, TM_PACKETS_RECOVERED, TM_PACKETS_REBUILT_EARLY, TM_DATA_BYTES, TM_PARITY_BYTES,
+    TM_RETRANSMIT_REQUESTS, TM_PACKETS_REQUESTED, TM_PACKETS_RETRANSMITTED, TM_FRAMES_REPAIRED,
+    TM_MEMORY_ERRORS, TM_LOG_MESSAGES, TM_LOG_DROPPED, TM_CLIENTS,
+    TM_CORE0_IDLE_PERMILLE, TM_CORE1_IDLE_PERMILLE,
+    TM_STRIP_DMA_BUSY_US, TM_STRIP_DMA_WAIT_US,
+    TM_BLOCKS_CHECKED, TM_BLOCKS_CHANGED, TM_DELTA_BYTES_SAVED,
+    TELEMETRY_COUNTER_COUNT
+  };
+  
+  constexpr uint16_t TELEMETRY_MAX_SIZE = TELEMETRY_HEADER_SIZE + TELEMETRY_COUNTER_COUNT * 4 +
+                                          TELEMETRY_MAX_STAGES * TELEMETRY_STAGE_FIELDS * 4 +
+                                          TELEMETRY_MAX_TASKS * TELEMETRY_TASK_ENTRY_SIZE;
+  
+  struct PacketHeader {
+    uint8_t version;
+    uint8_t flags;
+    uint8_t headerSize;
+    uint32_t frameId;
+    uint32_t frameLength;     // 0 when unknown (v1)
+    uint32_t byteOffset;
+    uint16_t packetIndex;
+    uint16_t totalPackets;
+    uint32_t payloadLength;
+    uint32_t captureTimeUs;   // Camera clock, 0 when unknown (v1)
+  };
+  
+  inline uint16_t load16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+  }
+  
+  inline uint32_t load32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+  
+  inline void store16(uint8_t* p, uint16_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+  }
+  
+  inline void store32(uint8_t* p, uint32_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+  }
+  
+  // Folds 'len' bytes of src into dst, as parity is built and used on both ends.
+  // Word-wide when both sides are aligned (payload offsets are multiples of 4).
+  inline void xorPayload(uint8_t* dst, const uint8_t* src, uint32_t len) {
+    uint32_t i = 0;
+    if ((((uintptr_t)dst | (uintptr_t)src) & 3) == 0) {
+      for (; i + 4 <= len; i += 4) {
+        *(uint32_t*)(dst + i) ^= *(const uint32_t*)(src + i);
+      }
+    }
+    
+    for (; i < len; i++) {
+      dst[i] ^= src[i];
+    }
+  }
+  
+  // Parses the first 'size' bytes of a datagram. Anything without the v2 magic
+  // is rejected right away unless v1 packets are accepted.
+  inline bool parseHeader(const uint8_t* data, int size, PacketHeader& header, bool acceptV1) {
+    if (size >= V2_HEADER_SIZE && load32(data) == MAGIC) {
+      if (data[4] != VERSION || data[6] < V2_HEADER_SIZE || data[6] > MAX_HEADER_SIZE) return false;
+      
+      header.version = VERSION;
+      header.flags = data[5];
+      header.headerSize = data[6];
+      header.frameId = load32(data + 8);
+      header.frameLength = load32(data + 12);
+      header.byteOffset = load32(data + 16);
+      header.packetIndex = load16(data + 20);
+      header.totalPackets = load16(data + 22);
+      header.payloadLength = load16(data + 24);
+      header.captureTimeUs = load32(data + 28);
+      return true;
+    }
+    
+    if (!acceptV1 || size < V1_HEADER_SIZE) return false;
+    
+    header.version = 1;
+    header.headerSize = V1_HEADER_SIZE;
+    header.frameId = load32(data);
+    header.totalPackets = load16(data + 4);
+    header.packetIndex = load16(data + 6);
+    header.payloadLength = load32(data + 8);
+    header.flags = header.packetIndex >= header.totalPackets ? FLAG_PARITY : 0;
+    header.byteOffset = (uint32_t)header.packetIndex * PAYLOAD_SIZE;
+    header.frameLength = 0;
+    header.captureTimeUs = 0;
+    return true;
+  }
+  
+  // Writes a header in the given version's layout, returns its size
+  inline int writeHeader(uint8_t* out, const PacketHeader& header, uint8_t version) {
+    if (version == 1) {
+      store32(out, header.frameId);
+      store16(out + 4, header.totalPackets);
+      store16(out + 6, header.packetIndex);
+      store32(out + 8, header.payloadLength);
+      return V1_HEADER_SIZE;
+    }
+    
+    store32(out, MAGIC);
+    out[4] = VERSION;
+    out[5] = header.flags;
+    out[6] = V2_HEADER_SIZE;
+    out[7] = 0;
+    store32(out + 8, header.frameId);
+    store32(out + 12, header.frameLength);
+    store32(out + 16, header.byteOffset);
+    store16(out + 20, header.packetIndex);
+    store16(out + 22, header.totalPackets);
+    store16(out + 24, header.payloadLength);
+    store16(out + 26, 0);
+    store32(out + 28, header.captureTimeUs);
+    return V2_HEADER_SIZE;
+  }
+}
+
+#endif // WIRE_PROTOCOL_H